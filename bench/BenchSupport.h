@@ -0,0 +1,31 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @file BenchSupport.h
+ * @brief Wall-clock timing for the host benchmarks.
+ *
+ * Notes:
+ *  - Host numbers only rank the alternatives; on AVR the gap is wider (no hardware
+ *    divide, 8-bit ALU), so read the ratios, not the nanoseconds.
+ */
+
+namespace sunlix {
+namespace bench {
+
+  /// Keeps a result alive so the measured loop is not optimised away.
+  inline volatile uint32_t& sink() { static volatile uint32_t v = 0; return v; }
+  inline void keep(uint32_t v) { sink() = v; }
+
+  /// ns per call of fn(i) over n calls.
+  template <typename Fn>
+  double nsPerOp(uint32_t n, Fn fn) {
+    const auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < n; ++i) fn(i);
+    const auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+  }
+
+}
+}
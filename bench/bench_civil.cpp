@@ -0,0 +1,129 @@
+// Cost of turning an uptime offset into a calendar date, for offsets from one day to a
+// century since the base:
+//  - the closed-form civil conversion against the day-by-day rollover loop it replaced;
+//  - UptimeDateTimeProvider::nowUtc() against the previous provider's nowUtc(), both read
+//    from the same simulated clock, each call in a new second (no calendar cache hit).
+#include "TimeHal.h"
+#include "CivilTime.h"
+#include "UptimeClock.h"
+#include "UptimeDateTimeProvider.h"
+#include "BenchSupport.h"
+#include <cstdio>
+
+using namespace sunlix;
+
+static bool leap(uint32_t y) { return (y % 4U == 0 && y % 100U != 0) || y % 400U == 0; }
+
+static uint8_t monthDays(uint32_t y, uint8_t m) {
+  static const uint8_t kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return (m == 2 && leap(y)) ? 29 : kDays[m - 1];
+}
+
+// The previous UptimeDateTimeProvider::addSeconds(): one loop iteration per elapsed day.
+static sunlix::DateTime addSecondsLoop(const sunlix::DateTime& in, uint32_t addS) {
+  sunlix::DateTime out = in;
+  const uint32_t total = in.hour * 3600U + in.minute * 60U + in.second + addS;
+  out.hour   = static_cast<uint8_t>((total / 3600U) % 24U);
+  out.minute = static_cast<uint8_t>((total / 60U) % 60U);
+  out.second = static_cast<uint8_t>(total % 60U);
+  for (uint32_t days = total / 86400U; days; --days) {
+    if (out.day < monthDays(out.year, out.month)) { ++out.day; continue; }
+    out.day = 1;
+    if (out.month < 12) ++out.month; else { out.month = 1; ++out.year; }
+  }
+  return out;
+}
+
+static sunlix::DateTime addSecondsCivil(const sunlix::DateTime& in, uint32_t addS) {
+  sunlix::DateTime out{};
+  civil::fromUnix(civil::toUnix(in) + addS, out);
+  return out;
+}
+
+// The previous provider's nowUtc(): base fields plus addSeconds() of the elapsed time.
+// It read the 32-bit millis() and broke at its wrap; the 64-bit counter is used here so
+// both providers report the same date and only the calendar step differs.
+struct LegacyUptime {
+  sunlix::DateTime base{};
+  uint64_t         t0Ms = 0;
+
+  void adjust(const sunlix::DateTime& t) { base = t; t0Ms = uptime::millis64(); }
+  void nowUtc(sunlix::DateTime& out) const {
+    const uint64_t elapsed = uptime::millis64() - t0Ms;
+    out = addSecondsLoop(base, static_cast<uint32_t>(elapsed / 1000U));
+    out.millis = static_cast<uint16_t>(elapsed % 1000U);
+  }
+};
+
+// Move the shared clock forward, sampling it often enough that no wrap is missed.
+static void advanceTo(uint64_t targetUs) {
+  while (hostsim::nowUs() < targetUs) {
+    const uint64_t left = targetUs - hostsim::nowUs();
+    hostsim::advanceUs(left < 1800000000ULL ? left : 1800000000ULL);   // 30 min
+    uptime::poll();
+  }
+}
+
+int main() {
+  static const uint32_t kBaseUnix = 946684800UL;   // 2000-01-01: +100 years fits in uint32
+  sunlix::DateTime base{};
+  civil::fromUnix(kBaseUnix, base);
+
+  hostsim::reset(1000000ULL);
+  UptimeDateTimeProvider provider;
+  LegacyUptime legacy;
+  (void)provider.begin();
+  (void)provider.adjust(base);
+  legacy.adjust(base);
+  const uint64_t t0Us = hostsim::nowUs();
+
+  static const struct { const char* name; uint32_t s; } kSpans[] = {
+    {"1 day", 86400UL}, {"49.7 days", 4294967UL}, {"1 year", 31536000UL},
+    {"10 years", 315360000UL}, {"50 years", 1577880000UL}, {"100 years", 3155760000UL},
+  };
+  std::printf("%-10s | %11s %11s %7s | %11s %11s %7s\n", "offset",
+              "loop ns", "civil ns", "ratio", "old nowUtc", "nowUtc", "ratio");
+  for (const auto& span : kSpans) {
+    const uint32_t n = span.s > 100000000UL ? 2000 : 200000;
+    const double loopNs = bench::nsPerOp(n, [&](uint32_t i) {
+      bench::keep(addSecondsLoop(base, span.s + i).day);
+    });
+    const double civilNs = bench::nsPerOp(200000, [&](uint32_t i) {
+      bench::keep(addSecondsCivil(base, span.s + i).day);
+    });
+    const sunlix::DateTime a = addSecondsLoop(base, span.s), b = addSecondsCivil(base, span.s);
+    if (a.year != b.year || a.month != b.month || a.day != b.day || a.second != b.second) {
+      std::fprintf(stderr, "civil mismatch at %s\n", span.name);
+      return 1;
+    }
+
+    // Providers: one call per simulated second; the clock step itself is timed and removed.
+    advanceTo(t0Us + static_cast<uint64_t>(span.s) * 1000000ULL);
+    sunlix::DateTime x{}, y{};
+    const double stepNs = bench::nsPerOp(n, [&](uint32_t) {
+      hostsim::advanceUs(1000000ULL);
+      bench::keep(static_cast<uint32_t>(uptime::millis64()));
+    });
+    const double oldNs = bench::nsPerOp(n, [&](uint32_t) {
+      hostsim::advanceUs(1000000ULL);
+      legacy.nowUtc(x);
+      bench::keep(x.day);
+    });
+    const double newNs = bench::nsPerOp(n, [&](uint32_t) {
+      hostsim::advanceUs(1000000ULL);
+      (void)provider.nowUtc(y);
+      bench::keep(y.day);
+    });
+    legacy.nowUtc(x);
+    (void)provider.nowUtc(y);
+    if (x.year != y.year || x.month != y.month || x.day != y.day || x.second != y.second) {
+      std::fprintf(stderr, "provider mismatch at %s\n", span.name);
+      return 1;
+    }
+    const double oldNet = oldNs - stepNs, newNet = newNs - stepNs;
+    std::printf("%-10s | %11.1f %11.1f %6.0fx | %11.1f %11.1f %6.0fx\n", span.name,
+                loopNs, civilNs, loopNs / civilNs, oldNet, newNet,
+                newNet > 0 ? oldNet / newNet : 0.0);
+  }
+  return 0;
+}
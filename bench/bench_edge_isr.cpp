@@ -0,0 +1,53 @@
+// Host-only proxy for the SQW edge ISR: the previous handler (32-bit divide to count the
+// seconds since the bound edge, then the base update) against EdgeSeqLock::publish().
+//
+// This is NOT the board cost. On the host EdgeSeqLock is the std::atomic variant and the
+// CPU divides in hardware, so the numbers only show that publish() does no arithmetic;
+// they do not predict an AVR or Cortex-M speedup. Board cycle counts come from the
+// examples/06_EdgeIsr_Cycles sketch (DWT cycle counter, volatile board path).
+#include "EdgeSeqLock.h"
+#include "BenchSupport.h"
+#include <cstdio>
+
+using namespace sunlix;
+
+namespace {
+
+// Shape of the previous RtcDateTimeProvider::onEdgeIsr_(), minus the micros() call.
+struct LegacyIsr {
+  volatile uint32_t lastIsrUs = 0, edgeSeq = 0, baseEdgeUs = 0, baseUnix = 0;
+  volatile bool     bound = true;
+
+  void onEdge(uint32_t nowUs) {
+    lastIsrUs = nowUs;
+    edgeSeq = edgeSeq + 1U;
+    if (!bound) return;
+    uint32_t n = (nowUs - baseEdgeUs) / 1000000UL;
+    if (n == 0) n = 1;
+    baseUnix   = baseUnix + n;
+    baseEdgeUs = nowUs;
+  }
+};
+
+}
+
+int main() {
+  const uint32_t kN = 20000000UL;
+  LegacyIsr legacy;
+  EdgeSeqLock lock;
+
+  const double legacyNs = bench::nsPerOp(kN, [&](uint32_t i) { legacy.onEdge(i * 1000003U); });
+  const double seqNs    = bench::nsPerOp(kN, [&](uint32_t i) { lock.publish(i * 1000003U); });
+
+  uint32_t count = 0, edgeUs = 0;
+  const double readNs = bench::nsPerOp(kN, [&](uint32_t) {
+    lock.read(count, edgeUs);
+    bench::keep(count ^ edgeUs);
+  });
+
+  std::printf("host proxy only (std::atomic seqlock, hardware divide); see 06_EdgeIsr_Cycles\n");
+  std::printf("legacy ISR body   %6.2f ns/edge\n", legacyNs);
+  std::printf("seqlock publish   %6.2f ns/edge\n", seqNs);
+  std::printf("seqlock read      %6.2f ns/read (loop side, uncontended)\n", readNs);
+  return 0;
+}
@@ -0,0 +1,54 @@
+// SQW frequency trade-off: ISR load against read error, with the MCU oscillator 300 ppm
+// off the DS3231 and 20 us of edge jitter. 1 Hz extrapolates the MCU clock between
+// edges; kHz modes re-anchor every edge at the cost of one ISR per edge.
+#include "RtcDateTimeProvider.h"
+#include <cstdio>
+
+using namespace sunlix;
+
+static void run(uint16_t hz) {
+  hostsim::reset(hostsim::nowUs() + 1000000ULL);
+  RTC_DS3231 rtc;
+  rtc.setSqwPin(2);
+  rtc.adjust(::DateTime(1760000000UL));
+  rtc.setDriftPpb(-300000);
+  rtc.setJitterUs(20);
+
+  RtcDateTimeProvider::Config c;
+  c.rtc   = &rtc;
+  c.sqwHz = hz;
+  RtcDateTimeProvider p(c);
+  if (!p.begin()) { std::printf("%5u Hz: begin failed\n", hz); return; }
+
+  const uint32_t isr0 = hostsim::isrCount();
+  const uint64_t t0   = hostsim::nowUs();
+  uint64_t u0 = 0, prev = 0;
+  (void)p.nowUnixUs(u0);
+  double maxErr = 0, sumErr = 0;
+  int n = 0, backwards = 0;
+  for (int i = 0; i < 60000; ++i) {
+    hostsim::advanceUs(997);
+    (void)p.poll();
+    uint64_t u = 0;
+    (void)p.nowUnixUs(u);
+    if (u < prev) ++backwards;
+    prev = u;
+    const double rtcUs = static_cast<double>(hostsim::nowUs() - t0) / 1.0003;   // RTC timebase
+    double e = static_cast<double>(u - u0) - rtcUs;
+    if (e < 0) e = -e;
+    if (e > maxErr) maxErr = e;
+    sumErr += e;
+    ++n;
+  }
+  const double secs = static_cast<double>(hostsim::nowUs() - t0) / 1e6;
+  std::printf("%5u Hz  isr/s %6.0f  mean|err| %7.1f us  max|err| %7.1f us  backwards %d\n",
+              hz, (hostsim::isrCount() - isr0) / secs, sumErr / n, maxErr, backwards);
+}
+
+int main() {
+  run(1);
+  run(1024);
+  run(4096);
+  run(8192);
+  return 0;
+}
@@ -2,8 +2,8 @@
  * Example: TimeService_NTP_WiFi (UNO R4 WiFi)
  * -------------------------------------------
  * - Connects to Wi-Fi (WiFiS3)
- * - Fetches UTC from NTP over UDP (pool.ntp.org)
- * - Feeds TimeService via callback (ntpFetchUtc)
+ * - Fetches UTC from NTP over UDP (pool.ntp.org) with the library's SNTP client
+ *   (UdpNtpTransport over WiFiUDP; round-trip delay compensated, sub-ms phase kept)
  * - Uses RTC DS3231 + SQW if present for sub-second phase; otherwise Uptime
  *
  * Prints current time every 500 ms as: YYYY-MM-DD HH:MM:SS.mmm
@@ -25,6 +25,7 @@
 #include "UptimeDateTimeProvider.h"
 #include "RtcDateTimeProvider.h"
 #include "TimeService.h"
+#include "UdpNtpTransport.h"
 
 using namespace sunlix;
 
@@ -35,7 +36,10 @@ using namespace sunlix;
 static constexpr const char* NTP_HOST     = "pool.ntp.org";
 static constexpr uint16_t    NTP_LOCAL_PORT = 2390;
 static constexpr uint16_t    NTP_TIMEOUT_MS = 1200;
+static constexpr uint16_t    NTP_DNS_TIMEOUT_MS = 2000;  // one lookup, cached afterwards
 static constexpr uint8_t     NTP_RETRIES    = 2;   // total attempts = 1 + retries
+static constexpr uint8_t     NTP_BURST      = 4;   // samples per sync; lowest-delay one is applied
+static constexpr uint16_t    NTP_FIRST_JITTER_S = 30;  // spread the first scheduled sync
 
 // RTC (optional)
 static constexpr uint8_t   SQW_PIN        = 2;
@@ -43,6 +47,7 @@ static constexpr PinStatus SQW_EDGE       = RISING;
 static constexpr bool      ENABLE_SQW_1HZ = true;
 static constexpr uint16_t  BIND_TIMEOUT   = 1500;
 static constexpr bool      REQUIRE_BIND   = true;
+static constexpr bool      ASYNC_BIND     = true;  // NTP re-syncs never wait for the SQW edge
 
 // Print cadence
 static constexpr uint32_t  PRINT_PERIOD_MS = 500;
@@ -51,8 +56,22 @@ static constexpr uint32_t  PRINT_PERIOD_MS = 500;
 RTC_DS3231 rtc;
 TimeService* ts = nullptr;
 WiFiUDP udp;
+UdpNtpTransport ntpTransport(udp, NTP_HOST, NTP_LOCAL_PORT);
 
 // ====================== Helpers ======================
+// DNS for UdpNtpTransport: runs once, in the first NTP open(); sends then use the cached IP.
+// WiFiS3 bounds the lookup with the modem's own command timeout.
+static bool resolveHost(const char* host, IPAddress& ip, uint16_t /*timeoutMs*/) {
+  return WiFi.hostByName(host, ip) == 1;
+}
+
+// Per-board seed for the first-sync jitter: the low MAC bytes differ between boards.
+static uint32_t macSeed() {
+  uint8_t mac[6] = {};
+  WiFi.macAddress(mac);
+  return (uint32_t(mac[2]) << 24) | (uint32_t(mac[3]) << 16) | (uint32_t(mac[4]) << 8) | mac[5];
+}
+
 static void printDateTime(const sunlix::DateTime& t) {
   char buf[48];
   snprintf(buf, sizeof(buf),
@@ -100,98 +119,6 @@ static bool connectWiFi(uint32_t overallTimeoutMs = 15000) {
   }
 }
 
-// Convert 64-bit NTP (seconds since 1900) → Unix epoch seconds (since 1970)
-static bool ntpToUnix(uint32_t secsSince1900, uint32_t& outUnix) {
-  // 2208988800 = seconds between 1900-01-01 and 1970-01-01
-  const uint32_t seventyYears = 2208988800UL;
-  if (secsSince1900 < seventyYears) return false;
-  outUnix = secsSince1900 - seventyYears;
-  return true;
-}
-
-// ====================== NTP fetch callback ======================
-static bool fetchNtpUtc(sunlix::DateTime& outUtc) {
-  // Ensure Wi-Fi
-  if (WiFi.status() != WL_CONNECTED) {
-    if (!connectWiFi()) return false;
-  }
-
-  // Start UDP
-  if (!udp.begin(NTP_LOCAL_PORT)) {
-    Serial.println(F("UDP.begin() failed"));
-    return false;
-  }
-
-  uint8_t packetBuffer[48];
-  memset(packetBuffer, 0, sizeof(packetBuffer));
-
-  // NTP request header: LI=0, VN=4, Mode=3 (client)
-  packetBuffer[0] = 0b11100011; // LI, Version, Mode
-  packetBuffer[1] = 0;  // Stratum
-  packetBuffer[2] = 6;  // Poll
-  packetBuffer[3] = 0xEC; // Precision
-  // bytes 12..15 (transmit timestamp "reference ID") can be any, leave 0
-
-  for (uint8_t attempt = 0; attempt <= NTP_RETRIES; ++attempt) {
-    // Send packet
-    if (udp.beginPacket(NTP_HOST, 123) == 0) {
-      Serial.println(F("beginPacket() failed"));
-      continue;
-    }
-    if (udp.write(packetBuffer, sizeof(packetBuffer)) != sizeof(packetBuffer)) {
-      Serial.println(F("udp.write() failed"));
-      udp.endPacket(); // flush
-      continue;
-    }
-    if (!udp.endPacket()) {
-      Serial.println(F("endPacket() failed"));
-      continue;
-    }
-
-    // Wait for response with timeout
-    uint32_t start = millis();
-    while ((millis() - start) < NTP_TIMEOUT_MS) {
-      int sz = udp.parsePacket();
-      if (sz >= 48) {
-        uint8_t resp[48];
-        udp.read(resp, 48);
-
-        // NTP seconds since 1900 are at bytes 40..43 (big-endian)
-        uint32_t secs1900 =
-          ((uint32_t)resp[40] << 24) |
-          ((uint32_t)resp[41] << 16) |
-          ((uint32_t)resp[42] <<  8) |
-          ((uint32_t)resp[43] <<  0);
-
-        uint32_t unixSecs;
-        if (!ntpToUnix(secs1900, unixSecs)) {
-          Serial.println(F("NTP epoch conversion failed"));
-          return false;
-        }
-
-        // Build fields via RTClib's DateTime (easy calendar math)
-        ::DateTime dt((uint32_t)unixSecs); // UTC
-        outUtc.year   = (uint16_t)dt.year();
-        outUtc.month  = (uint8_t) dt.month();
-        outUtc.day    = (uint8_t) dt.day();
-        outUtc.hour   = (uint8_t) dt.hour();
-        outUtc.minute = (uint8_t) dt.minute();
-        outUtc.second = (uint8_t) dt.second();
-        outUtc.millis = 0; // NTP subsecond not used here
-
-        udp.stop();
-        return true;
-      }
-      delay(10);
-    }
-
-    Serial.println(F("NTP timeout, retrying..."));
-  }
-
-  udp.stop();
-  return false;
-}
-
 // ====================== Arduino ======================
 void setup() {
   Serial.begin(115200);
@@ -211,6 +138,7 @@ void setup() {
 
   // Wi-Fi connect (best effort; NTP will re-check)
   (void)connectWiFi();
+  ntpTransport.setResolver(resolveHost, NTP_DNS_TIMEOUT_MS);
 
   // Configure TimeService
   TimeService::Config cfg;
@@ -220,9 +148,16 @@ void setup() {
   cfg.enableSqw1Hz  = ENABLE_SQW_1HZ;
   cfg.bindTimeoutMs = BIND_TIMEOUT;
   cfg.requireBind   = REQUIRE_BIND;
+  cfg.asyncBind     = ASYNC_BIND;
 
-  cfg.ntpOnBegin  = true;              // try once here
-  cfg.ntpFetchUtc = &fetchNtpUtc;      // real NTP callback
+  cfg.ntpOnBegin   = true;             // start one sync here (finished by poll())
+  cfg.ntpTransport = &ntpTransport;    // built-in SNTP client over WiFiUDP
+  cfg.ntpTimeoutMs = NTP_TIMEOUT_MS;
+  cfg.ntpRetries   = NTP_RETRIES;
+  cfg.ntpBurst     = NTP_BURST;
+  cfg.ntpAutoSync  = true;             // poll() re-syncs on an adaptive interval
+  cfg.ntpFirstSyncJitterS = NTP_FIRST_JITTER_S;
+  cfg.ntpJitterSeed = macSeed();       // boards powered up together still spread out
 
   static TimeService service(cfg);
   ts = &service;
@@ -246,10 +181,28 @@ void setup() {
 
 void loop() {
   static uint32_t lastPrint = 0;
-  static uint32_t lastNtpTry = 0;
 
   const uint32_t nowMs = millis();
 
+  // Background work (async SQW bind, NTP scheduler and exchange); never blocks
+  if (ts) ts->poll();
+
+  // Report the outcome of a sync once it finishes
+  static TimeService::NtpStep lastStep = TimeService::NtpStep::Idle;
+  if (ts && ts->ntpStep() != lastStep) {
+    lastStep = ts->ntpStep();
+    if (lastStep == TimeService::NtpStep::Done) {
+      Serial.print(F("NTP sync: OK, samples="));  Serial.print(ts->ntpFilter().count());
+      Serial.print(F(" delay_us="));              Serial.print(ts->ntpLastDelayUs());
+      Serial.print(F(" offset_ms="));             Serial.print((long)(ts->ntpLastOffsetUs() / 1000));
+      Serial.print(F(" next_s="));                Serial.println(ts->ntpIntervalS());
+    }
+    if (lastStep == TimeService::NtpStep::Failed) {
+      Serial.println(F("NTP sync: FAIL"));
+      if (WiFi.status() != WL_CONNECTED) (void)connectWiFi(); // the scheduler retries with backoff
+    }
+  }
+
   // Print current time
   if ((uint32_t)(nowMs - lastPrint) >= PRINT_PERIOD_MS) {
     lastPrint = nowMs;
@@ -261,15 +214,4 @@ void loop() {
       Serial.println(F("NO TIME"));
     }
   }
-
-  // Optional: try NTP periodically (e.g., every 5 minutes) to keep RTC fresh
-  const uint32_t NTP_PERIOD_MS = 300000UL;
-  if ((uint32_t)(nowMs - lastNtpTry) >= NTP_PERIOD_MS) {
-    lastNtpTry = nowMs;
-    if (ts) {
-      bool ok = ts->ntpSync();
-      Serial.print(F("NTP periodic sync: "));
-      Serial.println(ok ? F("OK") : F("FAIL"));
-    }
-  }
 }
@@ -0,0 +1,84 @@
+/**
+ * Example: EdgeIsrCycles
+ * ----------------------
+ * Cycle count of the SQW edge ISR body on the board: the previous handler (32-bit divide to
+ * count the seconds since the bound edge, then the base update) against the current
+ * EdgeSeqLock::publish() (volatile stores only; the arithmetic moved to the reader).
+ *
+ * What it does:
+ *  - Enables the DWT cycle counter (Cortex-M3/M4/M7: SAMD51, STM32F4, Teensy 3/4, ...).
+ *  - Calls each ISR body kCalls times with interrupts masked, subtracts the cost of the
+ *    same loop without the call, and prints cycles per edge once a second.
+ *
+ * Notes:
+ *  - micros() is left out of both bodies: the real ISR reads it (or the capture register)
+ *    either way, so it does not change the difference.
+ *  - Cortex-M0+ (SAMD21, RP2040) has no DWT cycle counter; this sketch does not build there.
+ *  - No RTC needed.
+ */
+
+#include <Arduino.h>
+#include "EdgeSeqLock.h"
+
+#if !defined(__ARM_ARCH_7M__) && !defined(__ARM_ARCH_7EM__)
+#error "EdgeIsrCycles needs the DWT cycle counter of a Cortex-M3/M4/M7"
+#endif
+
+static constexpr uint16_t kCalls = 256;
+
+// Shape of the previous RtcDateTimeProvider::onEdgeIsr_(), minus the micros() call.
+struct LegacyIsr {
+  volatile uint32_t lastIsrUs = 0, edgeSeq = 0, baseEdgeUs = 0, baseUnix = 0;
+  volatile bool     bound = true;
+
+  void onEdge(uint32_t nowUs) {
+    lastIsrUs = nowUs;
+    edgeSeq = edgeSeq + 1U;
+    if (!bound) return;
+    uint32_t n = (nowUs - baseEdgeUs) / 1000000UL;
+    if (n == 0) n = 1;
+    baseUnix   = baseUnix + n;
+    baseEdgeUs = nowUs;
+  }
+};
+
+static LegacyIsr           legacy;
+static sunlix::EdgeSeqLock seqLock;
+static volatile uint32_t   sink;
+
+static inline uint32_t cycles() { return DWT->CYCCNT; }
+
+// Cycles per call of fn(arg) over kCalls calls; args vary so the divide is not constant.
+template <typename Fn>
+static uint32_t cyclesPerCall(Fn fn) {
+  noInterrupts();
+  uint32_t t0 = cycles();
+  for (uint16_t i = 0; i < kCalls; ++i) sink = i * 1000003UL;
+  const uint32_t empty = cycles() - t0;
+  t0 = cycles();
+  for (uint16_t i = 0; i < kCalls; ++i) { sink = i * 1000003UL; fn(i * 1000003UL); }
+  const uint32_t full = cycles() - t0;
+  interrupts();
+  return (full - empty) / kCalls;
+}
+
+void setup() {
+  Serial.begin(115200);
+  while (!Serial && millis() < 3000) {}
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void loop() {
+  const uint32_t legacyCycles  = cyclesPerCall([](uint32_t us) { legacy.onEdge(us); });
+  const uint32_t publishCycles = cyclesPerCall([](uint32_t us) { seqLock.publish(us); });
+
+  Serial.print(F("legacy ISR body: "));
+  Serial.print(legacyCycles);
+  Serial.print(F(" cycles/edge, EdgeSeqLock::publish: "));
+  Serial.print(publishCycles);
+  Serial.println(F(" cycles/edge"));
+  delay(1000);
+}
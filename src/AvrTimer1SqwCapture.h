@@ -0,0 +1,82 @@
+#pragma once
+#if !defined(SUNLIX_TIME_HOST) && defined(__AVR_ATmega328P__)
+#include <Arduino.h>
+#include <avr/interrupt.h>
+#include "ISqwCapture.h"
+
+namespace sunlix {
+
+/**
+ * @class AvrTimer1SqwCapture
+ * @brief ISqwCapture on the ATmega328P Timer1 input-capture unit (ICP1 = D8 on Uno/Nano).
+ *
+ * Notes:
+ *  - Wire DS3231 SQW to D8 and set the provider's sqwPin = 8 (RISING or FALLING).
+ *  - Timer1 runs free at F_CPU/8 and ICR1 latches its count at the edge. The capture ISR
+ *    converts "ticks since the edge" to µs and subtracts them from micros(), so the result
+ *    has micros()' 4 µs granularity but no ISR entry latency or masking delay (< 32 ms).
+ *  - Takes Timer1 over (Servo, analogWrite() on D9/D10 stop working).
+ *  - Defines TIMER1_CAPT_vect: include this header in exactly one translation unit.
+ *
+ * Status: reference only; syntax-checked against a stub core, never built for AVR or run.
+ * The library itself does not build on the classic AVR core (it needs <cstdint> and
+ * PinStatus, which avr-libc and that core lack), so this backend cannot be used as is. It
+ * documents the ICP1 technique: only the provider side of ISqwCapture is tested (host,
+ * hal/SimSqwCapture.h).
+ */
+class AvrTimer1SqwCapture final : public ISqwCapture {
+public:
+  bool begin(uint8_t pin, PinStatus edge, void (*onEdge)()) override {
+    if (pin != 8 || (edge != RISING && edge != FALLING) || !onEdge) return false;
+    if (self_() && self_() != this) return false;         // one ICP1
+
+    pinMode(8, INPUT_PULLUP);
+    const uint8_t sreg = SREG;
+    cli();
+    onEdge_  = onEdge;
+    self_()  = this;
+    TCCR1A   = 0;                                          // normal mode, no outputs
+    TCCR1B   = _BV(ICNC1) | (edge == RISING ? _BV(ICES1) : 0) | _BV(CS11); // noise filter, clk/8
+    TIFR1    = _BV(ICF1);                                  // drop a stale capture
+    TIMSK1   = _BV(ICIE1);
+    SREG = sreg;
+    return true;
+  }
+
+  void end() override {
+    const uint8_t sreg = SREG;
+    cli();
+    TIMSK1 &= static_cast<uint8_t>(~_BV(ICIE1));
+    TCCR1B  = 0;
+    if (self_() == this) self_() = nullptr;
+    SREG = sreg;
+  }
+
+  uint32_t capturedUs() override { return capUs_; }
+
+  // Capture interrupt body (called from TIMER1_CAPT_vect below).
+  static void onCapture_() {
+    AvrTimer1SqwCapture* c = self_();
+    if (!c) return;
+    const uint16_t icr = ICR1;
+    const uint16_t tcnt = TCNT1;
+    const uint32_t now  = micros();
+    const uint16_t ticks = static_cast<uint16_t>(tcnt - icr);           // wraps after 32 ms
+    c->capUs_ = now - static_cast<uint32_t>(ticks / kTicksPerUs);
+    c->onEdge_();
+  }
+
+private:
+  static constexpr uint16_t kTicksPerUs = (F_CPU / 8000000UL) ? (F_CPU / 8000000UL) : 1;
+
+  static AvrTimer1SqwCapture*& self_() { static AvrTimer1SqwCapture* s = nullptr; return s; }
+
+  void (*onEdge_)() = nullptr;
+  volatile uint32_t capUs_ = 0;
+};
+
+}
+
+ISR(TIMER1_CAPT_vect) { sunlix::AvrTimer1SqwCapture::onCapture_(); }
+
+#endif
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include "IDateTimeProvider.h"
+#include "CivilTime.h"
+
+/**
+ * @file CalendarCache.h
+ * @brief One-second cache of decomposed calendar fields shared by providers.
+ *
+ * Notes:
+ *  - Date/hour/minute change at most once per second, so readers within the same
+ *    UNIX second just copy the cached struct and fill `millis`.
+ *  - Refresh is lazy: the first read in a new second (i.e. after an SQW edge or a
+ *    millis() second rollover) runs the civil conversion once.
+ *  - Invalidation rule: entries are keyed by UNIX second, so a base change can never
+ *    yield fields for the wrong second; providers still call invalidate() from
+ *    adjust()/begin() so the next read always decomposes the new base afresh.
+ */
+
+namespace sunlix {
+
+class CalendarCache {
+public:
+  /// Fill `out` with the fields of `unixSec`; `out.millis` is set to 0.
+  void get(std::uint32_t unixSec, DateTime& out) {
+    if (!valid_ || unixSec != unix_) refresh_(unixSec);
+    out = fields_;
+  }
+
+  /// Fill `out` (including millis) for UNIX milliseconds; no division on a hit.
+  void getMs(std::uint64_t unixMs, DateTime& out) {
+    if (valid_ && unixMs >= startMs_ && unixMs - startMs_ < 1000U) {
+      out = fields_;
+      out.millis = static_cast<std::uint16_t>(unixMs - startMs_);
+      return;
+    }
+    const std::uint32_t sec = static_cast<std::uint32_t>(unixMs / 1000U);
+    refresh_(sec);
+    out = fields_;
+    out.millis = static_cast<std::uint16_t>(unixMs - startMs_);
+  }
+
+  /// Drop the cached second (call on adjust()/begin()).
+  void invalidate() { valid_ = false; }
+
+private:
+  void refresh_(std::uint32_t unixSec) {
+    civil::fromUnix(unixSec, fields_);
+    unix_    = unixSec;
+    startMs_ = static_cast<std::uint64_t>(unixSec) * 1000U;
+    valid_   = true;
+  }
+
+  DateTime      fields_{};    // decomposed fields of unix_, millis = 0
+  std::uint64_t startMs_ = 0; // unix_ * 1000
+  std::uint32_t unix_    = 0;
+  bool          valid_   = false;
+};
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include "IDateTimeProvider.h"
+
+/**
+ * @file CivilTime.h
+ * @brief Closed-form civil calendar <-> UNIX day/second conversion shared by all providers.
+ *
+ * Notes:
+ *  - Proleptic Gregorian, UTC, no leap seconds; valid for 1970-01-01 .. 2105-12-31 (uint32 seconds).
+ *  - Constant time: no loops, no month tables (H. Hinnant's days_from_civil / civil_from_days).
+ *  - Only 32-bit unsigned arithmetic; safe on 8/16-bit MCUs where `int` is 16 bits.
+ */
+
+namespace sunlix {
+namespace civil {
+
+  constexpr std::uint32_t kSecondsPerDay = 86400UL;
+
+  /// Days since 1970-01-01 for a civil date (month 1..12, day 1..31, year >= 1970).
+  inline std::uint32_t daysFromCivil(std::uint16_t year, std::uint8_t month, std::uint8_t day) {
+    const std::uint32_t y   = static_cast<std::uint32_t>(year) - (month <= 2 ? 1U : 0U);
+    const std::uint32_t era = y / 400U;
+    const std::uint32_t yoe = y - era * 400U;                                        // [0, 399]
+    const std::uint32_t mp  = (month > 2) ? (month - 3U) : (month + 9U);             // Mar = 0
+    const std::uint32_t doy = (153U * mp + 2U) / 5U + day - 1U;                      // [0, 365]
+    const std::uint32_t doe = yoe * 365U + yoe / 4U - yoe / 100U + doy;              // [0, 146096]
+    return era * 146097UL + doe - 719468UL;
+  }
+
+  /// Civil date for a count of days since 1970-01-01.
+  inline void civilFromDays(std::uint32_t days, std::uint16_t& year, std::uint8_t& month, std::uint8_t& day) {
+    const std::uint32_t z   = days + 719468UL;
+    const std::uint32_t era = z / 146097UL;
+    const std::uint32_t doe = z - era * 146097UL;                                    // [0, 146096]
+    const std::uint32_t yoe = (doe - doe / 1460U + doe / 36524UL - doe / 146096UL) / 365U; // [0, 399]
+    const std::uint32_t doy = doe - (365U * yoe + yoe / 4U - yoe / 100U);            // [0, 365]
+    const std::uint32_t mp  = (5U * doy + 2U) / 153U;                                // [0, 11]
+    day   = static_cast<std::uint8_t>(doy - (153U * mp + 2U) / 5U + 1U);
+    month = static_cast<std::uint8_t>(mp < 10U ? mp + 3U : mp - 9U);
+    year  = static_cast<std::uint16_t>(yoe + era * 400U + (month <= 2 ? 1U : 0U));
+  }
+
+  /// UNIX seconds for the date/time fields of `t` (millis ignored).
+  inline std::uint32_t toUnix(const DateTime& t) {
+    return daysFromCivil(t.year, t.month, t.day) * kSecondsPerDay
+         + static_cast<std::uint32_t>(t.hour) * 3600UL
+         + static_cast<std::uint32_t>(t.minute) * 60UL
+         + static_cast<std::uint32_t>(t.second);
+  }
+
+  /// Fill date/time fields of `out` from UNIX seconds; sets millis to 0.
+  inline void fromUnix(std::uint32_t unixSec, DateTime& out) {
+    const std::uint32_t days = unixSec / kSecondsPerDay;
+    std::uint32_t sod = unixSec - days * kSecondsPerDay;
+    civilFromDays(days, out.year, out.month, out.day);
+    out.hour   = static_cast<std::uint8_t>(sod / 3600U);  sod -= static_cast<std::uint32_t>(out.hour) * 3600U;
+    out.minute = static_cast<std::uint8_t>(sod / 60U);
+    out.second = static_cast<std::uint8_t>(sod - static_cast<std::uint32_t>(out.minute) * 60U);
+    out.millis = 0;
+  }
+
+  /**
+   * Milliseconds in a subsecond microsecond phase, i.e. `us / 1000` without a divide.
+   * Valid for us < 1'000'000: divide by 8 with a shift, then by 125 with a 32-bit
+   * reciprocal multiply (estimate is exact or one low) and one correction step.
+   */
+  inline std::uint16_t usToMs(std::uint32_t us) {
+    const std::uint32_t x = us >> 3;                    // < 125000
+    std::uint32_t q = (x * 16777UL) >> 21;              // 16777 / 2^21 ~= 1/125
+    if (x - q * 125U >= 125U) ++q;
+    return static_cast<std::uint16_t>(q);
+  }
+
+  /// UNIX milliseconds for `t` (millis > 999 treated as 0).
+  inline std::uint64_t toUnixMs(const DateTime& t) {
+    const std::uint16_t ms = (t.millis <= 999) ? t.millis : 0;
+    return static_cast<std::uint64_t>(toUnix(t)) * 1000U + ms;
+  }
+
+  /// Fill all fields of `out` (including millis) from UNIX milliseconds.
+  inline void fromUnixMs(std::uint64_t unixMs, DateTime& out) {
+    const std::uint32_t sec = static_cast<std::uint32_t>(unixMs / 1000U);
+    fromUnix(sec, out);
+    out.millis = static_cast<std::uint16_t>(unixMs - static_cast<std::uint64_t>(sec) * 1000U);
+  }
+
+}
+}
@@ -0,0 +1,65 @@
+#include "ClockDiscipline.h"
+
+namespace sunlix {
+
+static constexpr uint64_t kMinFllIntervalUs = 16000000ULL; // shorter intervals: phase noise dominates
+
+void ClockDiscipline::reset(uint64_t at, bool keepFreq) {
+  t0_        = at;
+  baseUs_    = 0;
+  pendingUs_ = 0;
+  lastUpd_   = at;
+  hasLast_   = true;   // next update measures its FLL interval from here
+  if (!keepFreq) freqPpb_ = 0;
+}
+
+int64_t ClockDiscipline::slewedUs_(uint64_t at) const {
+  if (at <= t0_ || pendingUs_ == 0) return 0;
+  uint64_t dt = at - t0_;
+  if (dt > (1ULL << 40)) dt = 1ULL << 40;  // ~12.7 days; keeps dt·ppm in range
+  const int64_t maxUs = static_cast<int64_t>(dt * cfg_.maxSlewPpm / 1000000U);
+  if (pendingUs_ > 0) return pendingUs_ < maxUs ? pendingUs_ : maxUs;
+  return -pendingUs_ < maxUs ? pendingUs_ : -maxUs;
+}
+
+int64_t ClockDiscipline::freqUs_(uint64_t at) const {
+  if (!hasLast_ || at <= t0_ || freqPpb_ == 0) return 0;   // unanchored preload: not yet
+  const int64_t dtMs = static_cast<int64_t>((at - t0_) / 1000U); // ppb·ms/1e6 = µs, no overflow
+  return dtMs * freqPpb_ / 1000000;
+}
+
+int64_t ClockDiscipline::correctionUs(uint64_t at) const {
+  return baseUs_ + freqUs_(at) + slewedUs_(at);
+}
+
+void ClockDiscipline::update(int64_t offsetUs, uint64_t at) {
+  const int64_t leftUs = pendingUs(at);
+
+  // FLL: error that accumulated since the last update beyond what was still to be slewed
+  if (hasLast_ && at > lastUpd_ && at - lastUpd_ >= kMinFllIntervalUs) {
+    const int64_t residualUs = offsetUs - leftUs;
+    const int64_t dPpb = residualUs * 1000000000LL / static_cast<int64_t>(at - lastUpd_);
+    int64_t f = freqPpb_ + dPpb / 2;
+    if (f >  cfg_.maxFreqPpb) f =  cfg_.maxFreqPpb;
+    if (f < -cfg_.maxFreqPpb) f = -cfg_.maxFreqPpb;
+    freqPpb_ = static_cast<int32_t>(f);
+  }
+
+  // Fold the correction reached so far, then slew the whole measured offset from here
+  baseUs_    = correctionUs(at);
+  t0_        = at;
+  pendingUs_ = offsetUs;
+  lastUpd_   = at;
+  hasLast_   = true;
+}
+
+void ClockDiscipline::carry(int64_t offsetUs, uint64_t at) {
+  t0_        = at;
+  baseUs_    = offsetUs;
+  pendingUs_ = -offsetUs;
+  freqPpb_   = 0;        // the rate learned for the previous provider does not apply
+  lastUpd_   = at;
+  hasLast_   = true;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+
+namespace sunlix {
+
+/**
+ * @class ClockDiscipline
+ * @brief Phase/frequency correction added on top of a provider's time (NTP-style clock discipline).
+ *
+ * Model (all in µs of provider time `at`; t0 = time of the last update):
+ *   reported(at) = provider(at) + correctionUs(at)
+ *   correctionUs = base + freq·(at - t0) + slew(at - t0)
+ *  - Phase: an update's offset is not stepped but slewed in at no more than maxSlewPpm.
+ *  - Frequency (FLL): the part of each offset that was not already pending, divided by the
+ *    time since the previous update, is the residual rate error; half of it is added to freq.
+ *  - Continuity: an update first folds the correction reached so far into `base`, so the
+ *    reported time never jumps; with |freq| + maxSlewPpm < 1e6 ppm it never runs backwards.
+ *
+ * Stepping (above a threshold) is the caller's decision: step the provider, then reset().
+ */
+class ClockDiscipline {
+public:
+  struct Config {
+    uint16_t maxSlewPpm = 500;      ///< Phase slew limit.
+    int32_t  maxFreqPpb = 500000;   ///< Frequency correction clamp (±500 ppm).
+  };
+
+  void setConfig(const Config& cfg) { cfg_ = cfg; }
+
+  /// Drop phase state at provider time `at` (after a step); keepFreq keeps the learned rate.
+  void reset(uint64_t at, bool keepFreq = true);
+
+  /// Correction to add to the provider time `at`.
+  int64_t correctionUs(uint64_t at) const;
+
+  /// Feed a measured offset (reference - reported) taken at provider time `at`.
+  void update(int64_t offsetUs, uint64_t at);
+
+  /// Provider switch: report provider + offsetUs at `at`, then slew that offset back to 0.
+  void carry(int64_t offsetUs, uint64_t at);
+
+  /// Any correction in effect (learned rate, phase or carried offset).
+  bool active() const { return baseUs_ != 0 || pendingUs_ != 0 || (freqPpb_ != 0 && hasLast_); }
+
+  int32_t freqPpb()   const { return freqPpb_; }
+  /// Preload a rate (e.g. from a checkpoint). It applies only from the next reset()/update(),
+  /// which anchors t0 at a real provider time; before that there is nothing to integrate from.
+  void    setFreqPpb(int32_t ppb) { freqPpb_ = ppb; }
+  int64_t pendingUs(uint64_t at) const { return pendingUs_ - slewedUs_(at); } ///< phase left to slew
+
+private:
+  int64_t slewedUs_(uint64_t at) const;      // part of pendingUs_ slewed in by `at`
+  int64_t freqUs_(uint64_t at) const;        // freq·(at - t0)
+
+  Config   cfg_;
+  uint64_t t0_        = 0;   // provider time of the last update/reset
+  int64_t  baseUs_    = 0;   // correction at t0_
+  int64_t  pendingUs_ = 0;   // phase to slew in from t0_
+  int32_t  freqPpb_   = 0;
+  uint64_t lastUpd_   = 0;   // provider time of the last update (FLL interval)
+  bool     hasLast_   = false; // t0_/lastUpd_ anchored (by reset/update/carry)
+};
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#if defined(SUNLIX_TIME_HOST)
+#include <atomic>
+#endif
+
+namespace sunlix {
+
+/**
+ * @class EdgeSeqLock
+ * @brief Single-writer seqlock for an (edge count, edge time) pair written by an ISR.
+ *
+ * Notes:
+ *  - publish() is the only writer (the edge ISR); read() never masks interrupts and retries
+ *    if an edge landed mid-read. The sequence counter is 8-bit so its load is atomic on AVR.
+ *  - On boards the writer is an ISR on the reader's core: volatile accesses keep program
+ *    order, which is all a single core needs.
+ *  - On the host (SUNLIX_TIME_HOST) the writer may be another thread (stress test), so the
+ *    fields are std::atomic with the usual seqlock fences, and the counter is 32-bit (a
+ *    descheduled reader could otherwise miss exactly 128 writes); the protocol is the same.
+ */
+class EdgeSeqLock {
+public:
+  /// Writer (ISR only): one more edge, captured at edgeUs.
+  void publish(uint32_t edgeUs) {
+#if defined(SUNLIX_TIME_HOST)
+    const uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1U, std::memory_order_relaxed);                         // odd: writing
+    std::atomic_thread_fence(std::memory_order_release);
+    edgeUs_.store(edgeUs, std::memory_order_relaxed);
+    count_.store(count_.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+    seq_.store(s + 2U, std::memory_order_release);                         // even: stable
+#else
+    seq_++;
+    edgeUs_ = edgeUs;
+    count_++;
+    seq_++;
+#endif
+  }
+
+  /// Reader: consistent (count, edgeUs) pair.
+  void read(uint32_t& count, uint32_t& edgeUs) const {
+#if defined(SUNLIX_TIME_HOST)
+    uint32_t s0;
+    do {
+      do { s0 = seq_.load(std::memory_order_acquire); } while (s0 & 1U);
+      count  = count_.load(std::memory_order_relaxed);
+      edgeUs = edgeUs_.load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq_.load(std::memory_order_relaxed) != s0);
+#else
+    uint8_t s0;
+    do {
+      do { s0 = seq_; } while (s0 & 1U);
+      count  = count_;
+      edgeUs = edgeUs_;
+    } while (seq_ != s0);
+#endif
+  }
+
+private:
+#if defined(SUNLIX_TIME_HOST)
+  std::atomic<uint32_t> seq_{0};     // odd = write in progress
+  std::atomic<uint32_t> edgeUs_{0};  // last edge time
+  std::atomic<uint32_t> count_{0};   // edges so far (wraps)
+#else
+  volatile uint8_t  seq_    = 0;     // odd = write in progress
+  volatile uint32_t edgeUs_ = 0;     // last edge time
+  volatile uint32_t count_  = 0;     // edges so far (wraps)
+#endif
+};
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+#if !defined(SUNLIX_TIME_HOST) && defined(__has_include)
+#if __has_include(<EEPROM.h>)
+#include <Arduino.h>
+#include <EEPROM.h>
+#include "INvStore.h"
+
+namespace sunlix {
+
+/**
+ * @class EepromNvStore
+ * @brief INvStore over the Arduino EEPROM library (AVR, Renesas, ESP8266/ESP32 emulation).
+ *
+ * Notes:
+ *  - Uses [offset, offset + size) of the EEPROM; the rest stays with the application.
+ *  - Only bytes that differ are written (EEPROM cells have limited endurance).
+ *  - On ESP8266/ESP32 the application must call EEPROM.begin(n) first; commit() flushes.
+ */
+class EepromNvStore final : public INvStore {
+public:
+  EepromNvStore(uint16_t offset, uint16_t size) : offset_(offset), size_(size) {}
+
+  uint16_t size() const override { return size_; }
+
+  bool read(uint16_t addr, uint8_t* buf, uint16_t len) override {
+    if (static_cast<uint32_t>(addr) + len > size_) return false;
+    for (uint16_t i = 0; i < len; ++i) buf[i] = EEPROM.read(offset_ + addr + i);
+    return true;
+  }
+
+  bool write(uint16_t addr, const uint8_t* buf, uint16_t len) override {
+    if (static_cast<uint32_t>(addr) + len > size_) return false;
+    for (uint16_t i = 0; i < len; ++i) {
+      if (EEPROM.read(offset_ + addr + i) != buf[i]) EEPROM.write(offset_ + addr + i, buf[i]);
+    }
+    return true;
+  }
+
+  bool commit() override {
+#if defined(ESP8266) || defined(ESP32)
+    return EEPROM.commit();
+#else
+    return true;
+#endif
+  }
+
+private:
+  uint16_t offset_;
+  uint16_t size_;
+};
+
+}
+#endif
+#endif
@@ -0,0 +1,20 @@
+#include "IDateTimeProvider.h"
+#include "CivilTime.h"
+
+namespace sunlix {
+
+bool IDateTimeProvider::nowUnixMs(std::uint64_t& out) {
+  DateTime t{};
+  if (!nowUtc(t)) return false;
+  out = civil::toUnixMs(t);
+  return true;
+}
+
+bool IDateTimeProvider::nowUnixUs(std::uint64_t& out) {
+  std::uint64_t ms = 0;
+  if (!nowUnixMs(ms)) return false;
+  out = ms * 1000U;
+  return true;
+}
+
+}
@@ -8,6 +8,7 @@
  * Notes:
  *  - No dynamic allocation; fast calls.
  *  - Subsecond precision via `millis` (0..999); 0 means “not provided”.
+ *  - nowUnixMs()/nowUnixUs() return the raw epoch count; nowUtc() decomposes it into fields.
  */
 
 namespace sunlix {
@@ -28,7 +29,8 @@ namespace sunlix {
     Ok,
     NotStarted,
     LostPower,
-    NoDevice
+    NoDevice,
+    Stale       ///< degraded: time source stopped ticking; coarser fallback in use
   };
 
   /// Abstract time provider (e.g., RTC-backed or uptime-backed).
@@ -45,6 +47,20 @@ namespace sunlix {
      */
     virtual bool nowUtc(DateTime& out) = 0;
 
+    /**
+     * Get current time as milliseconds since 1970-01-01 00:00:00 UTC.
+     * No calendar decomposition; the default derives it from nowUtc(), providers override it.
+     * @return true if time is available.
+     */
+    virtual bool nowUnixMs(std::uint64_t& out);
+
+    /**
+     * Get current time as microseconds since 1970-01-01 00:00:00 UTC.
+     * Resolution is provider-specific (the default is milliseconds * 1000).
+     * @return true if time is available.
+     */
+    virtual bool nowUnixUs(std::uint64_t& out);
+
     /**
      * Apply a new time value.
      * @param[in] t     New time (millis expected in [0..999]; out-of-range treated as 0).
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file INtpTransport.h
+ * @brief Minimal datagram transport used by the built-in SNTP client.
+ *
+ * Notes:
+ *  - One server per transport instance (the implementation knows host/port).
+ *  - All calls must be non-blocking; receive() returns 0 while nothing has arrived.
+ *  - Implement it over WiFiUDP/EthernetUDP on boards (see UdpNtpTransport.h) or over an
+ *    in-process fake server on the host.
+ */
+
+namespace sunlix {
+
+  struct INtpTransport {
+    virtual ~INtpTransport() = default;
+
+    /// Prepare for an exchange (bind local port, resolve server...). Idempotent.
+    virtual bool open() = 0;
+
+    /// Send one datagram to the server; true if handed to the network stack.
+    virtual bool send(const std::uint8_t* data, std::uint8_t len) = 0;
+
+    /**
+     * Poll for one datagram from the server.
+     * @return bytes copied into `data` (truncated to `cap`), 0 if none yet, < 0 on error.
+     */
+    virtual int receive(std::uint8_t* data, std::uint8_t cap) = 0;
+
+    /// Release resources after an exchange.
+    virtual void close() = 0;
+  };
+}
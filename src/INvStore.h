@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file INvStore.h
+ * @brief Minimal byte-addressed non-volatile storage used for time checkpoints.
+ *
+ * Notes:
+ *  - The region [0, size()) belongs to the library; place it inside a larger EEPROM/flash
+ *    area with an offset in the implementation.
+ *  - write() may be buffered (flash-emulated EEPROM); commit() makes it durable.
+ *  - See EepromNvStore.h (boards with <EEPROM.h>) and hal/FileNvStore.h (host).
+ */
+
+namespace sunlix {
+
+  struct INvStore {
+    virtual ~INvStore() = default;
+
+    /// Bytes available to the library.
+    virtual std::uint16_t size() const = 0;
+
+    /// Copy `len` bytes at `addr` into `buf`; false if out of range or unreadable.
+    virtual bool read(std::uint16_t addr, std::uint8_t* buf, std::uint16_t len) = 0;
+
+    /// Store `len` bytes at `addr` (implementations should skip unchanged bytes).
+    virtual bool write(std::uint16_t addr, const std::uint8_t* buf, std::uint16_t len) = 0;
+
+    /// Flush buffered writes; default: writes are already durable.
+    virtual bool commit() { return true; }
+  };
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdint>
+#include "TimeHal.h"
+
+/**
+ * @file ISqwCapture.h
+ * @brief Optional hardware timestamping of SQW edges for RtcDateTimeProvider.
+ *
+ * Notes:
+ *  - Without a capture backend the provider reads micros() inside its edge ISR, so ISR entry
+ *    latency and any window with interrupts masked end up in the edge time.
+ *  - A backend latches a timer counter in hardware at the edge (input capture) and converts
+ *    it to the micros() timebase afterwards, so only the capture resolution remains.
+ *  - The provider passes its edge handler to begin(); the backend calls it from its capture
+ *    interrupt, and the handler reads capturedUs() right away.
+ *  - See hal/SimSqwCapture.h (host) and AvrTimer1SqwCapture.h (ATmega328P ICP1; reference
+ *    only, the library does not build on the classic AVR core).
+ */
+
+namespace sunlix {
+
+  struct ISqwCapture {
+    virtual ~ISqwCapture() = default;
+
+    /// Start capturing `edge` on `pin` and call `onEdge` (ISR context) after each capture;
+    /// false if this pin/edge cannot be captured.
+    virtual bool begin(std::uint8_t pin, PinStatus edge, void (*onEdge)()) = 0;
+
+    /// Stop capturing; onEdge is not called after this returns.
+    virtual void end() = 0;
+
+    /// micros() value at the latest captured edge (valid inside onEdge).
+    virtual std::uint32_t capturedUs() = 0;
+  };
+}
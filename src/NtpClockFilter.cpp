@@ -0,0 +1,24 @@
+#include "NtpClockFilter.h"
+
+namespace sunlix {
+
+void NtpClockFilter::add(const Entry& e) {
+  ring_[head_] = e;
+  head_ = static_cast<uint8_t>((head_ + 1) % kSize);
+  if (count_ < kSize) ++count_;
+}
+
+const NtpClockFilter::Entry& NtpClockFilter::entry(uint8_t i) const {
+  // newest is just behind head_
+  return ring_[(head_ + kSize - 1 - (i % kSize)) % kSize];
+}
+
+int8_t NtpClockFilter::best() const {
+  int8_t bi = -1;
+  for (uint8_t i = 0; i < count_; ++i) {
+    if (bi < 0 || entry(i).delayUs < entry(static_cast<uint8_t>(bi)).delayUs) bi = static_cast<int8_t>(i);
+  }
+  return bi;
+}
+
+}
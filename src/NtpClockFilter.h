@@ -0,0 +1,48 @@
+#pragma once
+#include <cstdint>
+
+namespace sunlix {
+
+/**
+ * @class NtpClockFilter
+ * @brief Fixed-size NTP sample register with minimum-delay selection (RFC 5905 clock filter).
+ *
+ * Design:
+ *  - add() shifts a sample into an 8-entry ring (no heap); clear() empties it.
+ *  - best() picks the sample with the lowest round-trip delay: the one least disturbed
+ *    by queueing, so its offset is the most trustworthy.
+ *  - Each entry keeps its UTC reference (unixUs valid at local micros() localUs) so the
+ *    chosen sample can be projected to "now" and applied.
+ */
+class NtpClockFilter {
+public:
+  static constexpr uint8_t kSize = 8;
+
+  struct Entry {
+    int64_t  offsetUs   = 0;  ///< Server UTC - local clock at reception (telemetry)
+    int32_t  delayUs    = 0;  ///< Round-trip delay
+    uint64_t refUnixUs  = 0;  ///< Server UTC (µs since 1970) ...
+    uint32_t refLocalUs = 0;  ///< ... valid at this micros()
+  };
+
+  void clear() { count_ = 0; head_ = 0; }
+
+  /// Shift a sample into the register (oldest dropped when full).
+  void add(const Entry& e);
+
+  /// Number of samples held (0..kSize).
+  uint8_t count() const { return count_; }
+
+  /// Sample i, 0 = newest.
+  const Entry& entry(uint8_t i) const;
+
+  /// Index (0 = newest) of the minimum-delay sample, or -1 if empty.
+  int8_t best() const;
+
+private:
+  Entry   ring_[kSize];
+  uint8_t head_  = 0;  // next write slot
+  uint8_t count_ = 0;
+};
+
+}
@@ -0,0 +1,69 @@
+#include "NtpSelector.h"
+
+namespace sunlix {
+
+bool NtpSelector::add(const Candidate& c) {
+  if (count_ >= kMaxSources) return false;
+  cand_[count_++] = c;
+  return true;
+}
+
+bool NtpSelector::select(uint8_t quorum, int64_t& outOffsetUs, int32_t& outDelayUs) {
+  survivors_ = 0;
+  if (count_ == 0) return false;
+  if (quorum < count_) quorum = count_;
+
+  // Interval endpoints: type -1 = lower (opens), +1 = upper (closes)
+  struct Edge { int64_t at; int8_t type; };
+  Edge e[2 * kMaxSources];
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < count_; ++i) {
+    const int64_t half = (cand_[i].delayUs > 0 ? cand_[i].delayUs : 0) / 2;
+    e[n++] = { cand_[i].offsetUs - half, -1 };
+    e[n++] = { cand_[i].offsetUs + half, +1 };
+  }
+
+  // Sort by position; at equal positions lower ends first so touching intervals intersect
+  for (uint8_t i = 1; i < n; ++i) {
+    const Edge k = e[i];
+    uint8_t j = i;
+    while (j > 0 && (e[j - 1].at > k.at || (e[j - 1].at == k.at && e[j - 1].type > k.type))) {
+      e[j] = e[j - 1];
+      --j;
+    }
+    e[j] = k;
+  }
+
+  // Sweep for the region covered by the most intervals
+  int8_t  depth = 0, bestDepth = 0;
+  int64_t lo = 0, hi = 0;
+  for (uint8_t i = 0; i < n; ++i) {
+    depth = static_cast<int8_t>(depth - e[i].type);
+    if (depth > bestDepth) {
+      bestDepth = depth;
+      lo = e[i].at;
+      hi = e[i + 1].at; // a lower end is never last
+    }
+  }
+  if (bestDepth * 2 <= quorum) return false; // no majority: refuse rather than follow a falseticker
+
+  // Survivors: candidates overlapping [lo, hi]; combine weighted by 1/delay
+  int64_t sumW = 0, sumWO = 0;
+  int32_t minDelay = INT32_MAX;
+  for (uint8_t i = 0; i < count_; ++i) {
+    const int64_t half = (cand_[i].delayUs > 0 ? cand_[i].delayUs : 0) / 2;
+    if (cand_[i].offsetUs + half < lo || cand_[i].offsetUs - half > hi) continue;
+    survivors_ |= static_cast<uint8_t>(1U << i);
+
+    const int64_t w = (1LL << 30) / (cand_[i].delayUs > 1000 ? cand_[i].delayUs : 1000); // cap at 1 ms
+    sumW  += w;
+    sumWO += w * (cand_[i].offsetUs - lo); // relative to lo keeps the product in range
+    if (cand_[i].delayUs < minDelay) minDelay = cand_[i].delayUs;
+  }
+
+  outOffsetUs = lo + sumWO / sumW;
+  outDelayUs  = minDelay;
+  return true;
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+
+namespace sunlix {
+
+/**
+ * @class NtpSelector
+ * @brief Falseticker rejection over a few NTP sources (Marzullo intersection, RFC 5905 style).
+ *
+ * Design:
+ *  - Each source contributes one candidate: its offset and round-trip delay. The true time
+ *    lies within [offset - delay/2, offset + delay/2] of a correct source (correctness interval).
+ *  - select() sorts the 2*N interval endpoints (N <= kMaxSources, insertion sort, no heap)
+ *    and sweeps them for the region covered by the most intervals.
+ *  - That region must be covered by a majority of `quorum` sources (normally the number
+ *    configured, not just the number that answered); otherwise nothing is selected.
+ *  - Survivors are the candidates whose interval overlaps the region; the result is their
+ *    offset averaged with weight 1/delay.
+ *
+ * Offsets are signed µs against any common reference the caller chooses.
+ */
+class NtpSelector {
+public:
+  static constexpr uint8_t kMaxSources = 4;
+
+  struct Candidate {
+    int64_t offsetUs = 0;
+    int32_t delayUs  = 0;
+  };
+
+  void clear() { count_ = 0; survivors_ = 0; }
+
+  /// Add one source's candidate; false when full.
+  bool add(const Candidate& c);
+
+  uint8_t count() const { return count_; }
+  const Candidate& candidate(uint8_t i) const { return cand_[i]; }
+
+  /// Run the selection; true if a majority of `quorum` agrees (combined offset in outOffsetUs).
+  bool select(uint8_t quorum, int64_t& outOffsetUs, int32_t& outDelayUs);
+
+  /// Bit i set if candidate i survived the last select().
+  uint8_t survivors() const { return survivors_; }
+
+private:
+  Candidate cand_[kMaxSources];
+  uint8_t   count_     = 0;
+  uint8_t   survivors_ = 0;
+};
+
+}
@@ -1,84 +1,514 @@
 #include "RtcDateTimeProvider.h"
+#include "CivilTime.h"
+#include "UptimeClock.h"
 
 namespace sunlix {
 
-RtcDateTimeProvider* RtcDateTimeProvider::s_active_ = nullptr;
+static_assert(SUNLIX_RTC_MAX_INSTANCES >= 1 && SUNLIX_RTC_MAX_INSTANCES < 0xFF,
+              "SUNLIX_RTC_MAX_INSTANCES out of range");
+
+RtcDateTimeProvider* volatile RtcDateTimeProvider::s_slots_[SUNLIX_RTC_MAX_INSTANCES] = {};
 
 RtcDateTimeProvider::RtcDateTimeProvider(const Config& cfg)
-: cfg_(cfg) {}
+: cfg_(cfg) {
+  switch (cfg_.sqwHz) {
+    case 1024: shift_ = 10; break;
+    case 4096: shift_ = 12; break;
+    case 8192: shift_ = 13; break;
+    default:   shift_ = 0;  break;   // 1 Hz (also for unsupported rates)
+  }
+}
+
+RtcDateTimeProvider::~RtcDateTimeProvider() {
+  detachIsr_();
+}
 
 // --- ISR ---
 
-void RtcDateTimeProvider::isrThunk_() {
-  if (s_active_) s_active_->onEdgeIsr_();
+template <uint8_t I>
+void RtcDateTimeProvider::isrSlot_() {
+  RtcDateTimeProvider* p = s_slots_[I];
+  if (p) p->onEdgeIsr_();
+}
+
+// Slot index → its trampoline, unrolled at compile time (no table in RAM).
+template <uint8_t I>
+RtcDateTimeProvider::IsrFn RtcDateTimeProvider::trampoline_(uint8_t slot) {
+  return (slot == I) ? &isrSlot_<I> : trampoline_<I + 1>(slot);
+}
+
+template <>
+RtcDateTimeProvider::IsrFn RtcDateTimeProvider::trampoline_<SUNLIX_RTC_MAX_INSTANCES>(uint8_t) {
+  return nullptr;
+}
+
+bool RtcDateTimeProvider::attachIsr_() {
+  if (slot_ == kNoSlot) {
+    for (uint8_t i = 0; i < SUNLIX_RTC_MAX_INSTANCES; ++i) {
+      if (!s_slots_[i]) { slot_ = i; break; }
+    }
+    if (slot_ == kNoSlot) return false;   // all slots taken
+  } else if (cfg_.capture) {
+    cfg_.capture->end();                  // begin() again: re-arm
+  } else {
+    detachInterrupt(digitalPinToInterrupt(cfg_.sqwPin)); // begin() again: re-attach
+  }
+
+  s_slots_[slot_] = this;                 // target first, then enable the interrupt
+  if (cfg_.capture) {
+    if (!cfg_.capture->begin(cfg_.sqwPin, cfg_.sqwEdge, trampoline_<0>(slot_))) {
+      s_slots_[slot_] = nullptr;
+      slot_ = kNoSlot;
+      return false;
+    }
+    return true;
+  }
+  pinMode(cfg_.sqwPin, INPUT_PULLUP);
+  attachInterrupt(digitalPinToInterrupt(cfg_.sqwPin), trampoline_<0>(slot_), cfg_.sqwEdge);
+  return true;
+}
+
+void RtcDateTimeProvider::detachIsr_() {
+  if (slot_ == kNoSlot) return;
+  if (cfg_.capture) cfg_.capture->end();               // no more calls before the slot is freed
+  else              detachInterrupt(digitalPinToInterrupt(cfg_.sqwPin));
+  s_slots_[slot_] = nullptr;
+  slot_ = kNoSlot;
 }
 
 void RtcDateTimeProvider::onEdgeIsr_() {
-  const uint32_t nowUs = micros();
-  lastIsrUs_ = nowUs;
-  edgeSeq_++;
+  // Capture + count only: no divisions, no base math with interrupts masked.
+  edges_.publish(cfg_.capture ? cfg_.capture->capturedUs() : micros());
+}
 
-  if (!bound_) return;
+// --- Helpers ---
 
-  // How many full seconds elapsed since the last bound edge?
-  const uint32_t d_us = nowUs - baseEdgeUs_;   // wrap-safe (unsigned)
-  uint32_t n = d_us / 1'000'000UL;             // usually 1; >1 if stalled/blocked
-  if (n == 0) n = 1;                           // at least one second definitely passed
+void RtcDateTimeProvider::snapshotEdge_(uint32_t& seq, uint32_t& edgeUs) const {
+  // Seqlock read side: interrupts stay enabled; retry if an edge landed mid-read.
+  edges_.read(seq, edgeUs);
+}
+
+uint64_t RtcDateTimeProvider::widen_(uint32_t edgeUs) {
+  const uint64_t now = uptime::micros64();
+  return now - static_cast<uint32_t>(static_cast<uint32_t>(now) - edgeUs); // edge is in the past
+}
+
+// Fold edges counted by the ISR since the last call into baseUnix_/baseEdgeUs_ (main context).
+void RtcDateTimeProvider::advanceBase_() {
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+  if (seq == baseSeq_) return;
+
+  // Edges resumed after a stale period: the chip may have browned out, so re-read its
+  // seconds at the next edge instead of trusting the count.
+  if (stale_) {
+    stale_ = false;
+    startBind_();
+    return;
+  }
+
+  // High-resolution: whole seconds are whole multiples of sqwHz edges; keep the remainder
+  if (shift_) {
+    const uint32_t whole = (seq - baseSeq_) >> shift_;
+    if (whole == 0) return;
+    baseUnix_ += whole;
+    baseSeq_  += whole << shift_;
+    return;
+  }
+
+  // Edges seen by the ISR, and whole seconds between the two captured edges
+  // (rounded, so ISR latency jitter cannot drop or add a second).
+  const uint32_t edges  = seq - baseSeq_;
+  const uint64_t edge64 = widen_(edgeUs);
+  const uint64_t d_us   = edge64 - baseEdgeUs_;           // 64-bit: no wrap
+  uint32_t n = static_cast<uint32_t>((d_us + 500'000UL) / 1'000'000UL); // > edges only if missed
+  if (n < edges) n = edges;                               // each counted edge is one second
+
+  // Every edge was seen: the captured gap is n periods (averaging also divides the ISR
+  // latency jitter by n), so sparse readers calibrate too. One sample per fold.
+  if (n == edges && d_us < 0xFFFFFFFFULL) {
+    trackPeriod_(n == 1 ? static_cast<uint32_t>(d_us) : static_cast<uint32_t>((d_us + n / 2) / n));
+  }
 
   baseUnix_   += n;
   // Anchor to the *actual* measured edge (reduces drift from ISR latency variance).
-  baseEdgeUs_  = nowUs;
+  baseEdgeUs_  = edge64;
+  baseSeq_     = seq;
 }
 
-// --- Helpers ---
+// Feed one measured SQW period into the period filter (main context, once per fold).
+void RtcDateTimeProvider::trackPeriod_(uint32_t periodUs) {
+  if (!cfg_.trackPeriod) return;
+  if (periodUs < 1'000'000UL - kMaxPeriodErrUs || periodUs > 1'000'000UL + kMaxPeriodErrUs) return; // outlier
+
+  const uint32_t sampleQ4 = periodUs << 4;
+  if (!periodValid_) {
+    periodQ4_    = sampleQ4;
+    periodValid_ = true;
+  } else {
+    // EMA, alpha = 1/16
+    periodQ4_ = static_cast<uint32_t>(static_cast<int32_t>(periodQ4_)
+              + ((static_cast<int32_t>(sampleQ4) - static_cast<int32_t>(periodQ4_)) >> 4));
+  }
 
-void RtcDateTimeProvider::mapRtclibToApp(const ::DateTime& in, DateTime& out) {
-  out.year   = static_cast<std::uint16_t>(in.year());
-  out.month  = static_cast<std::uint8_t >(in.month());
-  out.day    = static_cast<std::uint8_t >(in.day());
-  out.hour   = static_cast<std::uint8_t >(in.hour());
-  out.minute = static_cast<std::uint8_t >(in.minute());
-  out.second = static_cast<std::uint8_t >(in.second());
-  out.millis = 0;
+  updateScale_();
 }
 
-::DateTime RtcDateTimeProvider::rtclibFromApp(const DateTime& in) {
-  return ::DateTime(in.year, in.month, in.day, in.hour, in.minute, in.second);
+// Phase scale for readNow_(): (period - 1e6) / period in Q18 (one divide per edge, not per read)
+void RtcDateTimeProvider::updateScale_() {
+  const int32_t errQ4 = static_cast<int32_t>(periodQ4_) - static_cast<int32_t>(16'000'000L);
+  scaleQ18_ = static_cast<int32_t>((static_cast<int64_t>(errQ4) << 18) / static_cast<int64_t>(periodQ4_));
 }
 
-// Wait for the next SQW edge and bind baseUnix_/baseEdgeUs_ to that edge.
-bool RtcDateTimeProvider::bindOnNextEdge_(uint16_t timeoutMs) {
-  // Snapshot current edge counter
-  noInterrupts();
-  const uint32_t seq0 = edgeSeq_;
-  interrupts();
-
-  const uint32_t startMs = millis();
-  while (true) {
-    // Has an edge arrived?
-    noInterrupts();
-    const uint32_t seqNow = edgeSeq_;
-    const uint32_t edgeUs = lastIsrUs_;
-    interrupts();
-
-    if (seqNow != seq0) {
-      // Bind base to this real edge
-      if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
-      ::DateTime dt = cfg_.rtc->now(); // seconds *after* the edge
-      noInterrupts();
+bool RtcDateTimeProvider::setPeriodUs(uint32_t periodUs) {
+  if (periodUs < 1'000'000UL - kMaxPeriodErrUs || periodUs > 1'000'000UL + kMaxPeriodErrUs) return false;
+  periodQ4_    = periodUs << 4;
+  periodValid_ = true;     // later edges refine it through the EMA instead of replacing it
+  updateScale_();
+  return true;
+}
+
+int32_t RtcDateTimeProvider::ppmError() const {
+  // Period error in µs per nominal second == ppm
+  return (static_cast<int32_t>(periodQ4_) - static_cast<int32_t>(16'000'000L)) / 16;
+}
+
+// Arm a bind to the next SQW edge (non-blocking).
+void RtcDateTimeProvider::startBind_() {
+  uint32_t edgeUs = 0;
+  snapshotEdge_(bindSeq0_, edgeUs);
+  bindStartMs_ = millis();
+  bound_       = false;
+  stale_       = false;
+  bindSecKnown_ = false;   // kHz: first step reads the seconds register
+  bindPredicted_ = false;
+  bindState_   = BindState::Pending;
+}
+
+// One non-blocking bind step: bind baseUnix_/baseEdgeUs_ to the latest edge if one arrived.
+bool RtcDateTimeProvider::stepBind_() {
+  if (bindState_ != BindState::Pending) return bindState_ == BindState::Bound;
+  if (writePending_) {
+    if (!stepWrite_()) return false;
+  }
+  if (shift_) return stepBindKhz_();
+
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+
+  if (seq != bindSeq0_) {
+    if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
+    ::DateTime dt = cfg_.rtc->now(); // seconds *after* the edge
+
+    // The I2C read must fall inside the second that began at `seq`; else retry next step.
+    uint32_t seqAfter = 0, edgeAfter = 0;
+    snapshotEdge_(seqAfter, edgeAfter);
+    if (seqAfter == seq) {
       baseUnix_   = dt.unixtime();
-      baseEdgeUs_ = edgeUs;
+      baseEdgeUs_ = widen_(edgeUs);
+      baseSeq_    = seq;
       bound_      = true;
-      interrupts();
-      status_ = TimeStatus::Ok;
+      bindState_  = BindState::Bound;
+      refValid_   = false;
+      status_     = cfg_.rtc->lostPower() ? TimeStatus::LostPower : TimeStatus::Ok;
       return true;
     }
+  }
 
-    if (timeoutMs && static_cast<uint32_t>(millis() - startMs) >= timeoutMs) {
-      return false;
+  if (cfg_.bindTimeoutMs && static_cast<uint32_t>(millis() - bindStartMs_) >= cfg_.bindTimeoutMs) {
+    bindState_ = BindState::TimedOut;
+    if (cfg_.requireBind) status_ = TimeStatus::NoDevice;
+  }
+  return false;
+}
+
+// High-resolution bind. A step reads the seconds register once; when it changed since the
+// previous step, the boundary edge is known to within the edges between the two reads. That
+// is the bind if it is exactly one edge; otherwise it predicts the next boundary one second
+// later, and the step that comes close to it runs a read burst. A burst that still leaves
+// two candidate edges predicts them one second later again, and that step splits the pair
+// with a single read right after the first edge.
+bool RtcDateTimeProvider::stepBindKhz_() {
+  if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
+
+  const uint32_t hz = 1UL << shift_;
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+  const uint32_t gap = seq - pollSeq_;
+  pollSeq_ = seq;
+
+  if (bindPredicted_ && static_cast<int32_t>(bindLo_ - seq) <= static_cast<int32_t>(burstLead_(gap))) {
+    bindPredicted_ = false;
+    bindSecKnown_  = false;    // whatever happens, observe afresh
+    uint32_t b = 0, window = 0;
+    const Burst r = (bindHi_ - bindLo_ == 1U) ? pinBoundary_(bindLo_, bindNextSec_, b)
+                                              : burstBoundary_(bindNextSec_, bindHi_, b, window);
+    if (r == Burst::Found && window <= 1U) {
+      bindKhz_(bindNextSec_, b);
+      return true;
+    }
+    if (r == Burst::Found) {
+      // The boundary edge lies in (b - window, b] and in the prediction: bind if that pins
+      // one edge; otherwise predict the remaining pair one second later
+      const uint32_t lo = static_cast<int32_t>(b - window + 1U - bindLo_) > 0 ? b - window + 1U : bindLo_;
+      const uint32_t hi = static_cast<int32_t>(b - bindHi_) < 0 ? b : bindHi_;
+      if (lo == hi) {
+        bindKhz_(bindNextSec_, lo);
+        return true;
+      }
+      if (hi - lo == 1U) predictBoundary_(lo + hz, hi + hz, bindNextSec_ + 1U);
+    }
+  } else if (!bindPredicted_ || static_cast<int32_t>(seq - bindHi_) > 0) {
+    bindPredicted_ = false;
+    const uint32_t sec = cfg_.rtc->now().unixtime();   // latched right after `seq`
+    if (bindSecKnown_ && sec == bindSec_ + 1U && seq != bindSeq0_) {
+      const uint32_t window = seq - bindSeqPrev_;      // boundary edge in (prev, seq]
+      if (window == 1U) {
+        bindKhz_(sec, seq);
+        return true;
+      }
+      predictBoundary_(bindSeqPrev_ + 1U + hz, seq + hz, sec + 1U);
     }
-    delay(1); // be polite to the scheduler
+    bindSec_      = sec;
+    bindSeqPrev_  = seq;
+    bindSecKnown_ = true;
+  }
+
+  // Edges are arriving while a boundary is predicted: give it the second it is away
+  const uint32_t fromMs  = bindPredicted_ ? bindPredMs_ : bindStartMs_;
+  const uint32_t limitMs = cfg_.bindTimeoutMs + (bindPredicted_ ? 1000UL : 0UL);
+  if (cfg_.bindTimeoutMs && static_cast<uint32_t>(millis() - fromMs) >= limitMs) {
+    bindState_ = BindState::TimedOut;
+    if (cfg_.requireBind) status_ = TimeStatus::NoDevice;
   }
+  return false;
+}
+
+void RtcDateTimeProvider::predictBoundary_(uint32_t lo, uint32_t hi, uint32_t sec) {
+  bindPredicted_ = true;
+  bindLo_        = lo;
+  bindHi_        = hi;
+  bindNextSec_   = sec;
+  bindPredMs_    = millis();
+}
+
+uint32_t RtcDateTimeProvider::burstLead_(uint32_t gapEdges) const {
+  const uint32_t hz   = 1UL << shift_;
+  const uint32_t half = cfg_.khzBurstMaxMs * hz / 2000U;  // half of khzBurstMaxMs ...
+  uint32_t cap        = hz >> 4;                          // ... and ≤ 1/16 s of blocking reads
+  if (half < cap) cap = half;
+  const uint32_t lead = gapEdges + 2U;
+  return lead < cap ? lead : cap;
+}
+
+RtcDateTimeProvider::Burst RtcDateTimeProvider::burstBoundary_(uint32_t nextSec, uint32_t lastSeq,
+                                                               uint32_t& seqOut, uint32_t& window) {
+  uint32_t prev = 0, edgeUs = 0;
+  snapshotEdge_(prev, edgeUs);
+  uint32_t sec = cfg_.rtc->now().unixtime();
+  if (sec == nextSec) return Burst::Passed;
+  if (sec + 1U != nextSec) return Burst::Missed;
+
+  const uint32_t t0 = micros();
+  for (;;) {
+    uint32_t seq = 0;
+    snapshotEdge_(seq, edgeUs);
+    sec = cfg_.rtc->now().unixtime();
+    if (sec == nextSec) {
+      window = seq - prev;
+      if (window < 1U || window > 2U) return Burst::Missed;
+      seqOut = seq;
+      return Burst::Found;
+    }
+    // Wrong second (bus error), past the latest boundary, or no edges at all: give up
+    if (sec + 1U != nextSec || static_cast<int32_t>(seq - lastSeq) > 0
+        || micros() - t0 > cfg_.khzBurstMaxMs * 1000UL) return Burst::Missed;
+    prev = seq;
+  }
+}
+
+RtcDateTimeProvider::Burst RtcDateTimeProvider::pinBoundary_(uint32_t edge, uint32_t nextSec,
+                                                             uint32_t& seqOut) {
+  const uint32_t t0 = micros();
+  uint32_t seq = 0, edgeUs = 0;
+  for (;;) {
+    snapshotEdge_(seq, edgeUs);
+    if (static_cast<int32_t>(seq - edge) >= 0) break;
+    if (micros() - t0 > cfg_.khzBurstMaxMs * 1000UL) return Burst::Missed;
+    delayMicroseconds(2);
+  }
+  if (seq != edge) return Burst::Missed;        // too late to read between the two edges
+  const uint32_t sec = cfg_.rtc->now().unixtime();
+  if (sec == nextSec)            seqOut = edge;
+  else if (sec + 1U == nextSec)  seqOut = edge + 1U;
+  else return Burst::Missed;                    // bus error
+  return Burst::Found;
+}
+
+void RtcDateTimeProvider::bindKhz_(uint32_t sec, uint32_t seq) {
+  uint32_t now = 0, edgeUs = 0;
+  snapshotEdge_(now, edgeUs);
+  baseUnix_   = sec;
+  baseSeq_    = seq;
+  baseEdgeUs_ = widen_(edgeUs);
+  bound_      = true;
+  bindState_  = BindState::Bound;
+  refValid_   = false;
+  verifyMs_   = millis();
+  status_     = cfg_.rtc->lostPower() ? TimeStatus::LostPower : TimeStatus::Ok;
+  cache_.invalidate();
+}
+
+void RtcDateTimeProvider::verifyKhz_() {
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+  const uint32_t gap = seq - pollSeq_;
+  pollSeq_ = seq;
+  if (static_cast<uint32_t>(millis() - verifyMs_) < cfg_.khzVerifyS * 1000UL) return;
+
+  // Next counted boundary, and wait until it is one poll away
+  advanceBase_();
+  if (!bound_) return;
+  snapshotEdge_(seq, edgeUs);                  // not older than the fold
+  const uint32_t hz   = 1UL << shift_;
+  const uint32_t next = baseSeq_ + ((seq - baseSeq_) & ~(hz - 1U)) + hz;
+  if (static_cast<int32_t>(next - seq) > static_cast<int32_t>(burstLead_(gap))) return;
+  verifyMs_ = millis();                        // one attempt per interval
+
+  const uint32_t nextSec = baseUnix_ + ((next - baseSeq_) >> shift_);
+  uint32_t b = 0, window = 0;
+  switch (burstBoundary_(nextSec, next + burstLead_(gap), b, window)) {
+    case Burst::Found:
+      if (next - (b - window) - 1U < window) break;   // next in (b - window, b]: count is right
+      if (window == 1U) {                      // edges lost/gained, boundary pinned: re-base
+        baseSeq_  = b;
+        baseUnix_ = nextSec;
+        cache_.invalidate();
+      } else {
+        startBind_();                          // off, but by an edge the burst cannot pin
+      }
+      break;
+    case Burst::Passed:                        // chip already in nextSec: edges were lost
+      startBind_();
+      break;
+    case Burst::Missed:                        // noisy read or bus error: try next interval
+      break;
+  }
+}
+
+// Wait for the next SQW edge and bind baseUnix_/baseEdgeUs_ to that edge.
+bool RtcDateTimeProvider::bindOnNextEdge_() {
+  startBind_();
+  while (bindState_ == BindState::Pending) {
+    if (stepBind_()) return true;
+    if (shift_) delayMicroseconds(100); // kHz: poll the seconds register closely
+    else        delay(1);               // be polite to the scheduler
+  }
+  return false;
+}
+
+RtcDateTimeProvider::BindState RtcDateTimeProvider::poll() {
+  uptime::poll();                         // keeps the edge-gap clock across micros() wraps
+  if (bound_ && stale_) advanceBase_();   // edges resumed: re-arm the bind without waiting for a read
+  (void)stepBind_();
+  if (shift_ && bound_ && !stale_ && cfg_.khzVerifyS) verifyKhz_();
+  return bindState_;
+}
+
+void RtcDateTimeProvider::rebind() {
+  cache_.invalidate();
+  startBind_();
+}
+
+// MCU micros() that elapse while the RTC counts trueUs (scaled by the measured period).
+uint64_t RtcDateTimeProvider::mcuUs_(uint64_t trueUs) const {
+  return trueUs + static_cast<uint64_t>((static_cast<int64_t>(trueUs) * scaleQ18_) >> 18);
+}
+
+bool RtcDateTimeProvider::startAdjustUs(uint64_t unixUs) {
+  if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
+
+  // The DS3231 starts a second when its seconds register is written: write the *next*
+  // whole second of the requested time at the instant it begins.
+  const uint32_t fracUs = static_cast<uint32_t>(unixUs % 1'000'000ULL);
+  refUnixUs_    = unixUs;
+  refLocalUs_   = uptime::micros64();
+  refValid_     = true;
+  writeUnix_    = static_cast<uint32_t>(unixUs / 1'000'000ULL) + (fracUs ? 1U : 0U);
+  writeAtUs_    = refLocalUs_ + mcuUs_(fracUs ? 1'000'000UL - fracUs : 0U);
+  writePending_ = true;
+  writeRetries_ = 0;
+
+  cache_.invalidate();
+  startBind_();            // Pending until written and bound; reads use the reference
+  return true;
+}
+
+// Scheduled write: once its instant has come, write the RTC and arm the edge bind.
+bool RtcDateTimeProvider::stepWrite_() {
+  uint64_t now = uptime::micros64();
+  if (now < writeAtUs_) {
+    // Close enough: wait for the instant here rather than miss it by a loop() period
+    if (writeAtUs_ - now > static_cast<uint64_t>(cfg_.writeLeadMs) * 1000ULL) return false;
+    delayMicroseconds(static_cast<uint32_t>(writeAtUs_ - now));
+    now = uptime::micros64();
+  }
+
+  // Too late (loop() latency): the chip would keep that lag after a reboot, where phaseUs_
+  // is gone. Move the write to the next whole second instead, a few times.
+  uint64_t late = now - writeAtUs_;
+  if (late > kMaxWriteLateUs && writeRetries_ < kMaxWriteRetries) {
+    ++writeRetries_;
+    writeUnix_ += static_cast<uint32_t>(late / 1'000'000ULL) + 1U;
+    writeAtUs_  = refLocalUs_ + mcuUs_(static_cast<uint64_t>(writeUnix_) * 1'000'000ULL - refUnixUs_);
+    return false;
+  }
+
+  // Still late after the retries: the chip's seconds start that much after the requested
+  // phase; the provider adds it back to every bound reading (until the next reboot).
+  uint32_t lateSec = 0;
+  if (late >= 1'000'000ULL) {                     // stalled past whole seconds: rare
+    lateSec = static_cast<uint32_t>(late / 1'000'000ULL);
+    late   -= static_cast<uint64_t>(lateSec) * 1'000'000ULL;
+  }
+  cfg_.rtc->adjust(::DateTime(writeUnix_ + lateSec));
+  phaseUs_      = static_cast<uint32_t>(late);
+  writePending_ = false;
+  startBind_();
+  return true;
+}
+
+// Time from the adjust reference while the write/bind is pending (no I2C).
+void RtcDateTimeProvider::readRef_(uint32_t& unixSec, uint32_t& remUs) const {
+  const uint64_t d = uptime::micros64() - refLocalUs_;
+  const uint64_t t = refUnixUs_ + d - static_cast<uint64_t>((static_cast<int64_t>(d) * scaleQ18_) >> 18);
+  unixSec = static_cast<uint32_t>(t / 1'000'000ULL);
+  remUs   = static_cast<uint32_t>(t % 1'000'000ULL);
+}
+
+// Add the phase the chip lags the written time by (see stepWrite_()).
+void RtcDateTimeProvider::addPhase_(uint32_t& unixSec, uint32_t& remUs) const {
+  if (!phaseUs_) return;
+  remUs += phaseUs_;
+  if (remUs >= 1'000'000UL) { remUs -= 1'000'000UL; ++unixSec; }
+}
+
+uint32_t RtcDateTimeProvider::edgeCount() const {
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+  return seq;
+}
+
+bool RtcDateTimeProvider::probe() {
+  // Not rtc->begin(): RTClib 2.x re-creates its I2C device and re-runs Wire.begin() there
+  if (!cfg_.rtc) return false;
+  TwoWire& wire = cfg_.wire ? *cfg_.wire : Wire;
+  wire.beginTransmission(kI2cAddr);
+  return wire.endTransmission() == 0;
+}
+
+bool RtcDateTimeProvider::lostPower() {
+  return cfg_.rtc && cfg_.rtc->lostPower();
 }
 
 // --- IDateTimeProvider ---
@@ -89,26 +519,38 @@ bool RtcDateTimeProvider::begin() {
   // (Optional) probe device responsiveness early
   if (!cfg_.rtc->begin()) { status_ = TimeStatus::NoDevice; return false; }
 
-  s_active_ = this; // install ISR target
-
   if (cfg_.enableSqw1Hz) {
-    cfg_.rtc->writeSqwPinMode(DS3231_SquareWave1Hz);
+    switch (shift_) {
+      case 10: cfg_.rtc->writeSqwPinMode(DS3231_SquareWave1kHz); break;
+      case 12: cfg_.rtc->writeSqwPinMode(DS3231_SquareWave4kHz); break;
+      case 13: cfg_.rtc->writeSqwPinMode(DS3231_SquareWave8kHz); break;
+      default: cfg_.rtc->writeSqwPinMode(DS3231_SquareWave1Hz);  break;
+    }
   }
 
-  pinMode(cfg_.sqwPin, INPUT_PULLUP);
-  attachInterrupt(digitalPinToInterrupt(cfg_.sqwPin), &RtcDateTimeProvider::isrThunk_, cfg_.sqwEdge);
+  // Install this instance's ISR target
+  if (!attachIsr_()) { status_ = TimeStatus::NoDevice; return false; }
 
-  // Clear base
-  noInterrupts();
+  // Clear base (the edge count belongs to the ISR; the base only tracks differences)
+  cache_.invalidate();
   bound_      = false;
   baseUnix_   = 0;
   baseEdgeUs_ = 0;
-  edgeSeq_    = 0;
-  interrupts();
+  baseSeq_    = 0;
+  phaseUs_    = 0;       // unknown after a reset: the chip keeps whole seconds only
+  refValid_   = false;
+  writePending_ = false;
+
+  // Async: arm the bind and return; poll()/reads complete it at the next edge.
+  if (cfg_.asyncBind) {
+    startBind_();
+    status_ = cfg_.rtc->lostPower() ? TimeStatus::LostPower : TimeStatus::Ok;
+    return true;
+  }
 
   // Strict bind to the *next* real edge (per config)
-  if (!bindOnNextEdge_(cfg_.bindTimeoutMs)) {
-    if (cfg_.requireBind) { status_ = TimeStatus::NoDevice; return false; }
+  if (!bindOnNextEdge_()) {
+    if (cfg_.requireBind) { detachIsr_(); status_ = TimeStatus::NoDevice; return false; }
     // Soft start: not bound yet; nowUtc() will return seconds with .000 until first edge arrives.
     status_ = cfg_.rtc->lostPower() ? TimeStatus::LostPower : TimeStatus::Ok;
   } else {
@@ -117,62 +559,174 @@ bool RtcDateTimeProvider::begin() {
   return true;
 }
 
-bool RtcDateTimeProvider::nowUtc(DateTime& out) {
+bool RtcDateTimeProvider::readNow_(uint32_t& unixSec, uint32_t& remUs) {
   if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
 
-  // If not bound yet (soft mode), we cannot produce subsecond → seconds-only fallback.
-  noInterrupts();
-  const bool     bound    = bound_;
-  const uint32_t baseUnix = baseUnix_;
-  const uint32_t baseEdge = baseEdgeUs_;
-  interrupts();
+  // Opportunistically finish a pending async bind (cheap when no edge arrived).
+  if (bindState_ == BindState::Pending) (void)stepBind_();
+
+  // Adjusted, write or bind still pending: extrapolate the requested time
+  if (!bound_ && refValid_ && bindState_ == BindState::Pending) {
+    readRef_(unixSec, remUs);
+    if (status_ == TimeStatus::NotStarted) status_ = TimeStatus::Ok;
+    return true;
+  }
 
-  if (!bound) {
+  // If not bound yet (soft mode), we cannot produce subsecond → seconds-only fallback.
+  if (!bound_) {
     // One I2C read for seconds-only truth
-    ::DateTime now = cfg_.rtc->now();
-    mapRtclibToApp(now, out);
-    out.millis = 0;                 // subsecond not provided
+    unixSec = cfg_.rtc->now().unixtime();
+    remUs   = 0;                    // subsecond not provided
     // Keep status: Ok or LostPower depending on last known flag
     status_ = cfg_.rtc->lostPower() ? TimeStatus::LostPower : TimeStatus::Ok;
     return true;
   }
 
-  // Bound path: zero I2C here
-  const uint32_t nowUs = micros();
-  const uint32_t d_us  = nowUs - baseEdge;            // wrap-safe
-  const uint32_t whole = d_us / 1'000'000UL;
-  const uint32_t remus = d_us - whole * 1'000'000UL;
+  if (shift_) return readNowKhz_(unixSec, remUs);
+
+  // Bound path: zero I2C here; missed-edge reconstruction happens here, not in the ISR
+  advanceBase_();
+  if (!bound_) return readNow_(unixSec, remUs);      // stale binding just ended: re-binding
 
-  const uint32_t unixNow = baseUnix + whole;
-  ::DateTime dt(unixNow);
+  const uint64_t d64 = uptime::micros64() - baseEdgeUs_;
+
+  // Edge watchdog: SQW stopped → degrade to I2C seconds rather than extrapolate forever
+  if (cfg_.staleAfterEdges
+      && d64 >= static_cast<uint64_t>(cfg_.staleAfterEdges) * 1'000'000ULL + kEdgeGraceUs) {
+    stale_   = true;
+    unixSec  = cfg_.rtc->now().unixtime();
+    remUs    = 0;
+    status_  = TimeStatus::Stale;
+    return true;
+  }
 
-  mapRtclibToApp(dt, out);
-  out.millis = static_cast<std::uint16_t>(remus / 1000UL); // 0..999
+  uint32_t d_us  = (d64 >> 32) ? 0xFFFFFFFFUL : static_cast<uint32_t>(d64); // watchdog off: saturate
+  uint32_t whole = 0;
+
+  // Scale the phase by the measured SQW period: d_us * 1e6 / period, division-free.
+  // |d_us| < 2^20 and |scaleQ18_| <= 1311 keep the product inside int32.
+  if (d_us < (1UL << 20)) {
+    d_us -= static_cast<uint32_t>((static_cast<int32_t>(d_us) * scaleQ18_) >> 18);
+    // Edge due but not yet seen: hold at .999 instead of rolling over and stepping back
+    if (d_us >= 1'000'000UL && d_us < 1'000'000UL + kEdgeGraceUs) d_us = 999'999UL;
+  }
+
+  if (d_us >= 1'000'000UL) {
+    // Edge overdue (missed or stopped): usually just one second
+    d_us -= 1'000'000UL; whole = 1;
+    if (d_us >= 1'000'000UL) {                        // rare: edges stopped; slow path
+      const uint32_t more = d_us / 1'000'000UL;
+      whole += more;
+      d_us  -= more * 1'000'000UL;
+    }
+  }
+
+  unixSec = baseUnix_ + whole;
+  remUs   = d_us;
+  addPhase_(unixSec, remUs);
 
   // Keep Ok even if RTC once reported LostPower; that flag is sticky until adjust()
-  if (status_ == TimeStatus::NotStarted) status_ = TimeStatus::Ok;
+  if (status_ == TimeStatus::NotStarted || status_ == TimeStatus::Stale) status_ = TimeStatus::Ok;
   return true;
 }
 
-bool RtcDateTimeProvider::adjust(const DateTime& t) {
-  if (!cfg_.rtc) { status_ = TimeStatus::NoDevice; return false; }
+bool RtcDateTimeProvider::readNowKhz_(uint32_t& unixSec, uint32_t& remUs) {
+  uint32_t seq = 0, edgeUs = 0;
+  snapshotEdge_(seq, edgeUs);
+
+  // Edge watchdog, in edge periods (plus the same grace as 1 Hz mode)
+  const uint64_t sinceEdge = uptime::micros64() - widen_(edgeUs);
+  if (cfg_.staleAfterEdges
+      && sinceEdge >= ((static_cast<uint64_t>(cfg_.staleAfterEdges) * 1'000'000ULL) >> shift_) + kEdgeGraceUs) {
+    stale_   = true;
+    unixSec  = cfg_.rtc->now().unixtime();
+    remUs    = 0;
+    status_  = TimeStatus::Stale;
+    return true;
+  }
+  if (stale_) {                 // edges resumed: the count no longer matches the chip
+    startBind_();
+    return readNow_(unixSec, remUs);
+  }
+
+  // Fold whole seconds, then take the phase from a snapshot no older than the fold
+  advanceBase_();
+  snapshotEdge_(seq, edgeUs);
+  const uint64_t sinceLast = uptime::micros64() - widen_(edgeUs);
+
+  const uint32_t sub = seq - baseSeq_;                       // may run 1 s ahead of the fold
+  const uint32_t periodUs = 1'000'000UL >> shift_;           // 976/244/122 (truncated)
+  uint32_t intra = static_cast<uint32_t>(sinceLast);
+  if (sinceLast >= periodUs) intra = periodUs - 1;           // next edge late: hold
 
-  // 1) Write new time to RTC (seconds only; millis are undefined on DS3231)
-  ::DateTime rt = rtclibFromApp(t);
-  cfg_.rtc->adjust(rt);
+  const uint32_t whole = sub >> shift_;
+  const uint32_t inSec = sub & ((1UL << shift_) - 1U);
+  unixSec = baseUnix_ + whole;
+  remUs   = static_cast<uint32_t>((static_cast<uint64_t>(inSec) * 1'000'000ULL) >> shift_) + intra;
+  if (remUs > 999'999UL) remUs = 999'999UL;
+  addPhase_(unixSec, remUs);
 
-  // 2) Re-bind base at the next real edge (up to bindTimeoutMs)
-  noInterrupts(); bound_ = false; interrupts();
-  if (!bindOnNextEdge_(cfg_.bindTimeoutMs)) {
-    if (cfg_.requireBind) { status_ = TimeStatus::NoDevice; return false; }
-    // Soft: stay unbound; nowUtc() will return seconds + .000 until edge arrives.
+  if (status_ == TimeStatus::NotStarted || status_ == TimeStatus::Stale) status_ = TimeStatus::Ok;
+  return true;
+}
+
+bool RtcDateTimeProvider::nowUtc(DateTime& out) {
+  uint32_t unixSec = 0, remUs = 0;
+  if (!readNow_(unixSec, remUs)) return false;
+
+  // Date/time fields change once per second: decomposed once, then copied
+  cache_.get(unixSec, out);
+  out.millis = civil::usToMs(remUs); // 0..999, division-free
+  return true;
+}
+
+bool RtcDateTimeProvider::nowUnixUs(std::uint64_t& out) {
+  uint32_t unixSec = 0, remUs = 0;
+  if (!readNow_(unixSec, remUs)) return false;
+
+  out = static_cast<std::uint64_t>(unixSec) * 1'000'000UL + remUs;
+  return true;
+}
+
+bool RtcDateTimeProvider::nowUnixMs(std::uint64_t& out) {
+  uint32_t unixSec = 0, remUs = 0;
+  if (!readNow_(unixSec, remUs)) return false;
+
+  out = static_cast<std::uint64_t>(unixSec) * 1000U + civil::usToMs(remUs);
+  return true;
+}
+
+bool RtcDateTimeProvider::adjust(const DateTime& t) {
+  // Schedule the write at the next whole second (keeps t.millis), then re-bind
+  if (!startAdjustUs(civil::toUnixMs(t) * 1000U)) return false;
+  if (cfg_.asyncBind) {
+    status_ = TimeStatus::Ok;   // completes in poll()/reads; extrapolated until then
+    return true;
+  }
+
+  // Blocking: wait for the write instant (closely at the end), then for the next edge
+  while (writePending_) {
+    const uint64_t now = uptime::micros64();
+    if (now + 2000U < writeAtUs_)  delay(1);
+    else if (now < writeAtUs_)     delayMicroseconds(static_cast<uint32_t>(writeAtUs_ - now));
+    (void)stepBind_();
+  }
+  while (bindState_ == BindState::Pending) {
+    if (stepBind_()) break;
+    if (shift_) delayMicroseconds(100);
+    else        delay(1);
+  }
+  if (bindState_ != BindState::Bound && cfg_.requireBind) {
+    status_ = TimeStatus::NoDevice;
+    return false;
   }
+  // Soft: stay unbound; nowUtc() will return seconds + .000 until edge arrives.
   status_ = TimeStatus::Ok;
   return true;
 }
 
 bool RtcDateTimeProvider::isBound() const {
-  noInterrupts(); bool b = bound_; interrupts(); return b;
+  return bound_; // written from main context only
 }
 
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 #pragma once
-#include <Arduino.h>
-#include <RTClib.h>
+#include "TimeHal.h"
 #include "IDateTimeProvider.h"
+#include "CalendarCache.h"
+#include "ISqwCapture.h"
+#include "EdgeSeqLock.h"
+
+/// Live RtcDateTimeProvider instances that can own an SQW interrupt at the same time.
+#ifndef SUNLIX_RTC_MAX_INSTANCES
+#define SUNLIX_RTC_MAX_INSTANCES 2
+#endif
 
 namespace sunlix {
 
@@ -13,17 +20,73 @@ namespace sunlix {
  *  - begin(): waits for the next SQW edge (configurable timeout) and binds a base:
  *      baseUnix   = rtc.now().unixtime() at that real edge,
  *      baseEdgeUs = micros() timestamp captured by ISR at that edge.
- *  - ISR on each SQW edge: NO I2C; only updates base by whole seconds (handles missed edges)
- *    and stores the latest micros() of the edge.
+ *  - ISR on each SQW edge: NO I2C, NO math; stores the micros() of the edge and bumps a counter.
+ *    Readers fold counted edges into the base outside interrupt context (handles missed edges).
+ *  - ISR dispatch: each begun instance takes a slot in a static table of
+ *    SUNLIX_RTC_MAX_INSTANCES pointers, and attaches the trampoline compiled for that slot
+ *    (one load + call, as with a single instance). No heap; begin() fails with NoDevice when
+ *    all slots are taken; the destructor detaches and frees the slot.
+ *  - ISR/reader handoff is a seqlock (EdgeSeqLock: ISR = sole writer, readers retry on a
+ *    torn read), so no read path masks interrupts.
  *  - nowUtc(): NO I2C when bound; computes unix + millis from (baseUnix, baseEdgeUs).
  *              If not bound yet (soft start), returns rtc.now() with millis=0.
- *  - adjust(): writes RTC time and re-binds base on the next edge.
+ *  - nowUnixUs()/nowUnixMs(): same source as nowUtc(), returned as an epoch count
+ *              without calendar decomposition.
+ *  - adjust()/startAdjustUs(): the DS3231 keeps whole seconds and restarts its countdown
+ *    when written, so the write is scheduled for the instant the next whole second of the
+ *    requested time begins (t.millis / the µs fraction are kept), then the base re-binds on
+ *    the next edge. The chip itself must carry the phase across reboots, so a poll() within
+ *    writeLeadMs of the instant waits for it, and a write that would still land more than
+ *    1 ms late (loop() slower than writeLeadMs) moves to the next whole second, up to 3 times;
+ *    only after that is the lateness measured and added back in RAM (phaseUs_).
+ *  - trackPeriod: each fold of edges (gap between captured edges / edges, when none was
+ *    missed) feeds an EMA of the real micros() length of an SQW second, however rarely the
+ *    application reads; the subsecond phase is scaled by it, so a resonator that is off by
+ *    hundreds of ppm no longer produces a sawtooth before each edge (see ppmError()).
+ *  - asyncBind: begin()/adjust() only arm the bind and return immediately; it completes
+ *    in poll() (or any read) after the next edge. bindState() reports progress.
+ *  - Calendar fields are cached per second (CalendarCache); most nowUtc() calls only
+ *    copy the cached struct and fill millis. begin()/adjust() invalidate the cache.
+ *  - High-resolution mode (sqwHz = 1024/4096/8192): the DS3231 outputs its kHz square wave
+ *    and the same capture-and-count ISR runs per edge. The phase is the edge count since the
+ *    bound second boundary, shifted by log2(sqwHz) (the rate is a power of two), plus
+ *    micros() since the last edge capped at one edge period, so the MCU oscillator only
+ *    matters inside one edge (≤ 977 µs). The second boundary is the edge count at the first
+ *    read of the seconds register that shows the new second (the chip latches its time at
+ *    the start of a read); the base is only bound once that pins exactly one edge.
+ *    Bind steps note roughly where the second changed; when the next boundary is about one
+ *    poll away, a tight burst of reads finds it to within 2 edges. A 2-edge result,
+ *    intersected with the prediction, is split one second later by a single read right
+ *    after the first of the two edges. A predicted boundary extends bindTimeoutMs by the
+ *    second it is away (at 8192 Hz a read spans more than one edge, so the bind takes up
+ *    to ~3 s).
+ *    Every khzVerifyS the same burst checks the counted boundary against the chip, so edges
+ *    lost while interrupts were masked are corrected (re-based on a one-edge result,
+ *    re-bound otherwise) instead of shifting the phase for good.
+ *    Blocking: the burst runs inside poll() (or the read that advances the bind), asyncBind
+ *    or not. It starts about one poll gap before the predicted boundary and ends at it, so
+ *    it blocks for roughly two loop() periods (~2-5 ms with a 1 ms loop), once per bind and
+ *    once per khzVerifyS. Worst case (slow loop, wide prediction): khzBurstMaxMs (default
+ *    130 ms); a burst that would run longer is abandoned and retried a second later, so a
+ *    small khzBurstMaxMs bounds the stall but needs a fast loop() to bind at all.
+ *    Trade-off: sqwHz interrupts per second, and loop() slower than 1/16 s only binds
+ *    through the blocking paths (begin()/adjust() without asyncBind).
+ *  - Capture backend (optional ISqwCapture): the edge time comes from a hardware input-capture
+ *    latch instead of micros() in the ISR, so ISR entry latency and masked-interrupt windows
+ *    no longer move baseEdgeUs_ or the period filter. The backend owns the interrupt and
+ *    calls the same slot trampoline; everything downstream is unchanged. begin() fails with
+ *    NoDevice if the backend cannot capture sqwPin/sqwEdge.
+ *  - Edge watchdog: the base edge time is kept in 64-bit uptime::micros64() time (the ISR
+ *    still captures 32-bit micros(); readers widen it), so a long gap between edges can
+ *    never wrap. With no edge for staleAfterEdges periods the binding is stale: reads use
+ *    the I2C seconds and report Stale; the next edge re-binds.
  *
  * Status semantics:
  *  - Ok          : normal operation (bound to SQW) OR seconds-only fallback (see below).
  *  - NotStarted  : begin() not called or failed.
  *  - LostPower   : RTC reported lost power (sticky until re-adjust or external fix).
  *  - NoDevice    : RTC pointer missing or device not responding.
+ *  - Stale       : bound, but SQW edges stopped; seconds-only from I2C until they return.
  */
 class RtcDateTimeProvider final : public IDateTimeProvider {
 public:
@@ -31,49 +94,206 @@ public:
     RTC_DS3231* rtc = nullptr;    ///< Must be non-null; rtc->begin() must be called by the user.
     uint8_t     sqwPin = 2;       ///< Interrupt-capable pin wired to DS3231 SQW.
     PinStatus         sqwEdge = RISING; ///< RISING or FALLING (choose one; do not use CHANGE).
-    bool        enableSqw1Hz = true; ///< Set DS3231_SquareWave1Hz on begin().
+    bool        enableSqw1Hz = true; ///< Program the SQW output (rate = sqwHz) on begin().
+    uint16_t    sqwHz = 1;        ///< 1, 1024, 4096 or 8192 (kHz = high-resolution mode).
     uint16_t    bindTimeoutMs = 1500;///< Max time to wait for the next edge (0 = wait forever).
     bool        requireBind   = true;///< If true and timeout fires → begin() returns false.
+    bool        asyncBind     = false;///< If true, begin()/adjust() never wait; see poll().
+    bool        trackPeriod   = true; ///< Measure the micros() length of an SQW second and scale by it.
+    uint8_t     staleAfterEdges = 3;  ///< Missing SQW periods before the binding is stale (0 = never).
+    ISqwCapture* capture = nullptr;   ///< Hardware edge timestamps (nullptr = micros() in the ISR).
+    uint16_t    khzVerifyS = 16;      ///< kHz mode: check the counted second boundary this often (0 = never).
+    uint8_t     khzBurstMaxMs = 130;  ///< kHz mode: longest blocking read burst (bind, check); see notes.
+    uint8_t     writeLeadMs = 10;     ///< startAdjustUs(): poll() this close to the write instant waits for it.
+    TwoWire*    wire = nullptr;       ///< Bus the DS3231 is on, for probe() (nullptr = Wire).
+  };
+
+  /// Progress of binding the base to a real SQW edge.
+  enum class BindState : uint8_t {
+    Unbound,   ///< begin() not called yet
+    Pending,   ///< waiting for the next edge
+    Bound,     ///< base bound to a real edge
+    TimedOut   ///< no edge within bindTimeoutMs (seconds-only fallback)
   };
 
   explicit RtcDateTimeProvider(const Config& cfg);
+  ~RtcDateTimeProvider() override;
+
+  RtcDateTimeProvider(const RtcDateTimeProvider&) = delete;            // owns an ISR slot
+  RtcDateTimeProvider& operator=(const RtcDateTimeProvider&) = delete;
 
   // IDateTimeProvider
   bool begin() override;
   bool nowUtc(DateTime& out) override;
+  bool nowUnixMs(std::uint64_t& out) override;
+  bool nowUnixUs(std::uint64_t& out) override;
+  /// Set the RTC, keeping t.millis (see class notes). Blocking (no asyncBind): waits up to
+  /// 1 s for the write instant, then for the bind: up to bindTimeoutMs (1 Hz: one edge,
+  /// ~1 s; kHz: up to ~3 s). With asyncBind it returns at once; poll() finishes the work.
   bool adjust(const DateTime& t) override;
   TimeStatus status() const override { return status_; }
 
   /// Whether the provider is currently bound to a real SQW edge.
   bool isBound() const;
 
+  /// Current bind progress.
+  BindState bindState() const { return bindState_; }
+
+  /// Advance a pending async bind by one non-blocking step (and re-arm it once SQW edges
+  /// resume after a stale period); call from loop(). Also runs uptime::poll(), so the SQW
+  /// watchdog sees the true gap even if nothing reads the clock for hours.
+  BindState poll();
+
+  /// Re-bind to the next SQW edge without writing the RTC (non-blocking; finish with poll()).
+  void rebind();
+
+  /// Set the time to unixUs (µs since 1970) without blocking: the RTC is written when the
+  /// next whole second of it begins, then re-bound; finish with poll(). Until bound, reads
+  /// extrapolate unixUs with micros().
+  bool startAdjustUs(std::uint64_t unixUs);
+
+  /// SQW edges seen by the ISR so far (wraps); a health monitor watches it advance.
+  uint32_t edgeCount() const;
+
+  /// I2C liveness check: one address-only transaction (ACK from 0x68), no register access.
+  bool probe();
+
+  /// The chip's oscillator-stop flag (OSF): its time is not valid since it lost power.
+  bool lostPower();
+
+  /// Edges per second in use (1 or the kHz rate).
+  uint16_t sqwHz() const { return static_cast<uint16_t>(1U << shift_); }
+
+  /// Filtered micros() length of one SQW second (1'000'000 until measured).
+  uint32_t measuredPeriodUs() const { return periodQ4_ >> 4; }
+  bool     hasMeasuredPeriod() const { return periodValid_; }
+
+  /// Estimated MCU oscillator error vs. the DS3231 in ppm (positive = micros() runs fast).
+  int32_t ppmError() const;
+
+  /// Preload the period filter (e.g. from a stored checkpoint); false if out of range.
+  bool setPeriodUs(uint32_t periodUs);
+
 private:
-  // --- ISR plumbing (single active instance) ---
-  static void isrThunk_();   // attachInterrupt target
-  void onEdgeIsr_();         // instance handler
+  // --- ISR plumbing (one slot per live instance) ---
+  using IsrFn = void (*)();
+  static constexpr uint8_t kNoSlot = 0xFF;
+  static constexpr uint8_t kI2cAddr = 0x68;          // DS3231 7-bit address
+
+  template <uint8_t I> static void isrSlot_();        // attachInterrupt target for slot I
+  template <uint8_t I> static IsrFn trampoline_(uint8_t slot);
+  bool attachIsr_();                                  // claim a slot and attach
+  void detachIsr_();
+  void onEdgeIsr_();                                  // instance handler
 
   // --- helpers ---
-  static void mapRtclibToApp(const ::DateTime& in, DateTime& out);
-  static ::DateTime rtclibFromApp(const DateTime& in);
+  /// Consistent snapshot of the ISR-owned (edge count, edge time) pair (seqlock, no IRQ masking).
+  void snapshotEdge_(uint32_t& seq, uint32_t& edgeUs) const;
+  /// Fold edges counted since the last call into the base (main context only).
+  void advanceBase_();
+
+  /// Widen an ISR micros() capture to uptime::micros64() time (capture < 71 min old).
+  static uint64_t widen_(uint32_t edgeUs);
+
+  /// Update the SQW period filter with one measured period.
+  void trackPeriod_(uint32_t periodUs);
+  void updateScale_();
+
+  /// Current UNIX second + microseconds into it (bound: from SQW base, else one I2C read).
+  bool readNow_(uint32_t& unixSec, uint32_t& remUs);
+  /// readNow_() bound path in high-resolution mode: phase from the edge count.
+  bool readNowKhz_(uint32_t& unixSec, uint32_t& remUs);
+  /// High-resolution bind step: locate the seconds register change, then burst across it.
+  bool stepBindKhz_();
+  /// Outcome of a read burst across an expected second boundary.
+  enum class Burst : uint8_t { Found, Passed, Missed };
+  /// Tight reads until the seconds register shows nextSec (see class notes): the boundary
+  /// edge is in (seqOut - window, seqOut]. Passed: already there at the first read.
+  /// Missed: no clean change by lastSeq.
+  Burst burstBoundary_(uint32_t nextSec, uint32_t lastSeq, uint32_t& seqOut, uint32_t& window);
+  /// The boundary is `edge` or `edge + 1`: wait for `edge`, then one read tells which.
+  Burst pinBoundary_(uint32_t edge, uint32_t nextSec, uint32_t& seqOut);
+  /// kHz: the boundary that begins second `sec` is one of the edges [lo, hi].
+  void predictBoundary_(uint32_t lo, uint32_t hi, uint32_t sec);
+  /// Edges before an expected boundary at which a step starts the burst (the poll gap, capped).
+  uint32_t burstLead_(uint32_t gapEdges) const;
+  /// kHz: bind the base to the boundary edge `seq` that began second `sec`.
+  void bindKhz_(uint32_t sec, uint32_t seq);
+  /// kHz, bound: every khzVerifyS check the counted boundary with a burst; re-base on a mismatch.
+  void verifyKhz_();
 
-  /// Wait for the next SQW edge and bind baseUnix_/baseEdgeUs_; returns success.
-  bool bindOnNextEdge_(uint16_t timeoutMs);
+  /// Scheduled write (startAdjustUs()): write once its instant has come.
+  bool stepWrite_();
+  /// Requested time extrapolated to now (write/bind pending).
+  void readRef_(uint32_t& unixSec, uint32_t& remUs) const;
+  /// Add phaseUs_ to a bound reading.
+  void addPhase_(uint32_t& unixSec, uint32_t& remUs) const;
+  /// MCU micros() elapsing while the RTC counts trueUs (measured period).
+  uint64_t mcuUs_(uint64_t trueUs) const;
+
+  /// Arm a bind to the next edge; stepBind_() completes it without blocking.
+  void startBind_();
+  bool stepBind_();
+  /// Wait (up to bindTimeoutMs) for the next SQW edge and bind to it; returns success.
+  bool bindOnNextEdge_();
 
 private:
   Config     cfg_;
   TimeStatus status_ = TimeStatus::NotStarted;
 
-  // Base mapping to the last *real* second edge
-  volatile bool     bound_      = false;  // base is valid
-  volatile uint32_t baseUnix_   = 0;      // UNIX second at the last edge
-  volatile uint32_t baseEdgeUs_ = 0;      // micros() timestamp of that edge
+  // Base mapping to the last *processed* second edge (main context only)
+  bool     bound_      = false;  // base is valid
+  uint32_t baseUnix_   = 0;      // UNIX second at the base edge
+  uint64_t baseEdgeUs_ = 0;      // micros64() timestamp of that edge
+  bool     stale_      = false;  // bound, but no edge for staleAfterEdges periods
+  uint32_t baseSeq_    = 0;      // edge count of that edge
+
+  // MCU oscillator calibration (period of one SQW second in micros() ticks)
+  static constexpr uint32_t kMaxPeriodErrUs = 5000;  // reject samples beyond ±5000 ppm
+  static constexpr uint32_t kEdgeGraceUs    = 2000;  // hold .999 this long for a late edge
+  static constexpr uint32_t kMaxWriteLateUs = 1000;  // later scheduled writes move a second on ...
+  static constexpr uint8_t  kMaxWriteRetries = 3;    // ... this many times, then phaseUs_ covers it
+  uint32_t periodQ4_    = 16'000'000UL; // filtered period, µs * 16
+  int32_t  scaleQ18_    = 0;            // (period - 1e6) / period, Q18
+  bool     periodValid_ = false;
+
+  // Bind state machine
+  BindState bindState_   = BindState::Unbound;
+  uint32_t  bindSeq0_    = 0;    // edge count when the bind was armed
+  uint32_t  bindStartMs_ = 0;    // millis() when the bind was armed
+  uint32_t  bindSec_     = 0;    // kHz: seconds register at the previous poll ...
+  uint32_t  bindSeqPrev_ = 0;    // ... and the edge count just before that read
+  bool      bindSecKnown_ = false;
+  bool      bindPredicted_ = false; // kHz: next boundary lies in [bindLo_, bindHi_] ...
+  uint32_t  bindLo_      = 0;
+  uint32_t  bindHi_      = 0;
+  uint32_t  bindNextSec_ = 0;    // ... and begins this second
+  uint32_t  bindPredMs_  = 0;    // millis() when that was predicted
+  uint32_t  pollSeq_     = 0;    // kHz: edge count at the previous step (poll gap)
+  uint32_t  verifyMs_    = 0;    // kHz: millis() of the last boundary check
+
+  // Scheduled write with sub-second phase (startAdjustUs())
+  bool     writePending_ = false;
+  uint8_t  writeRetries_ = 0;    // writes moved on for being late
+  uint32_t writeUnix_    = 0;    // second to write ...
+  uint64_t writeAtUs_    = 0;    // ... at this micros64(), when it begins
+  uint32_t phaseUs_      = 0;    // chip seconds start this late vs. the written time
+  bool     refValid_     = false;
+  uint64_t refUnixUs_    = 0;    // requested time ...
+  uint64_t refLocalUs_   = 0;    // ... at this micros64() (reads while pending)
+
+  // High-resolution mode: edges per second = 1 << shift_ (0 = 1 Hz mode)
+  uint8_t   shift_       = 0;
+
+  // Decomposed fields of the current second (refreshed on first read after an edge)
+  CalendarCache cache_;
 
-  // Diagnostics / ISR snapshot
-  volatile uint32_t lastIsrUs_  = 0;      // last edge micros
-  volatile uint32_t edgeSeq_    = 0;      // edge counter
+  // ISR snapshot: edge count + last edge micros (or captured time); written only by the ISR
+  EdgeSeqLock edges_;
 
-  // Single-instance ISR target
-  static RtcDateTimeProvider* s_active_;
+  // ISR targets, indexed by slot
+  uint8_t slot_ = kNoSlot;
+  static RtcDateTimeProvider* volatile s_slots_[SUNLIX_RTC_MAX_INSTANCES];
 };
 
 }
\ No newline at end of file
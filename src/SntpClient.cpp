@@ -0,0 +1,100 @@
+#include "SntpClient.h"
+
+namespace sunlix {
+
+// --- Helpers ---
+
+uint64_t SntpClient::readTs_(const uint8_t* p) {
+  uint64_t v = 0;
+  for (uint8_t i = 0; i < 8; ++i) v = (v << 8) | p[i];
+  return v;
+}
+
+uint64_t SntpClient::ntpTsToUnixUs_(uint64_t ts) {
+  uint64_t sec = ts >> 32;
+  // RFC 4330 §3: MSB clear means era 1 (after 2036-02-07)
+  if (!(sec & 0x80000000ULL)) sec += 0x100000000ULL;
+  const uint64_t fracUs = ((ts & 0xFFFFFFFFULL) * 1'000'000ULL) >> 32;
+  return (sec - kNtpToUnixOffset) * 1'000'000ULL + fracUs;
+}
+
+bool SntpClient::send_() {
+  uint8_t pkt[kPacketLen] = {};
+  pkt[0] = 0x23;  // LI=0, VN=4, Mode=3 (client)
+
+  // Transmit timestamp = opaque token; a valid reply echoes it as originate.
+  token_ = (static_cast<uint64_t>(++tokenSeq_) << 32) | micros();
+  for (uint8_t i = 0; i < 8; ++i) pkt[40 + i] = static_cast<uint8_t>(token_ >> (56 - 8 * i));
+
+  sentMs_ = millis();
+  t1Us_   = micros();
+  return cfg_.transport->send(pkt, kPacketLen);
+}
+
+bool SntpClient::parse_(const uint8_t* p, uint32_t t4) {
+  const uint8_t li      = p[0] >> 6;
+  const uint8_t mode    = p[0] & 0x07;
+  const uint8_t stratum = p[1];
+  if (mode != 4 || li == 3) return false;            // not a server reply / unsynchronized
+  if (stratum == 0 || stratum > 15) return false;    // kiss-o'-death or invalid
+
+  if (readTs_(p + 24) != token_) return false;       // originate must echo our request
+  const uint64_t t2 = readTs_(p + 32);
+  const uint64_t t3 = readTs_(p + 40);
+  if (t3 == 0 || t3 < t2) return false;
+
+  // Server processing time (T3 - T2) in µs; sane replies take well under a second
+  const uint64_t procTs = t3 - t2;
+  if (procTs >> 32) return false;
+  const uint32_t procUs = static_cast<uint32_t>((procTs * 1'000'000ULL) >> 32);
+
+  const uint32_t rttUs   = t4 - t1Us_;               // wrap-safe
+  const int32_t  delayUs = (rttUs > procUs) ? static_cast<int32_t>(rttUs - procUs) : 0;
+
+  sample_.unixUs  = ntpTsToUnixUs_(t3) + static_cast<uint32_t>(delayUs) / 2U;
+  sample_.localUs = t4;
+  sample_.delayUs = delayUs;
+  sample_.stratum = stratum;
+  return true;
+}
+
+// --- Public API ---
+
+bool SntpClient::start() {
+  if (!cfg_.transport || !cfg_.transport->open()) { state_ = State::Failed; return false; }
+  attempt_ = 0;
+  if (!send_()) {
+    cfg_.transport->close();
+    state_ = State::Failed;
+    return false;
+  }
+  state_ = State::Waiting;
+  return true;
+}
+
+SntpClient::State SntpClient::poll() {
+  if (state_ != State::Waiting) return state_;
+
+  uint8_t buf[kPacketLen];
+  const int n = cfg_.transport->receive(buf, kPacketLen);
+  const uint32_t t4 = micros();                      // as close to reception as we can get
+
+  if (n >= static_cast<int>(kPacketLen) && parse_(buf, t4)) {
+    cfg_.transport->close();
+    state_ = State::Done;
+    return state_;
+  }
+  // Short, invalid or stale datagrams are ignored; keep waiting for the real reply.
+
+  if (n < 0 || static_cast<uint32_t>(millis() - sentMs_) >= cfg_.timeoutMs) {
+    if (attempt_ < cfg_.retries) {
+      ++attempt_;
+      if (send_()) return state_;                    // retry with a fresh token
+    }
+    cfg_.transport->close();
+    state_ = State::Failed;
+  }
+  return state_;
+}
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include "TimeHal.h"
+#include "INtpTransport.h"
+
+namespace sunlix {
+
+/**
+ * @class SntpClient
+ * @brief Non-blocking SNTP (RFC 4330) client core over an INtpTransport.
+ *
+ * Design:
+ *  - start(): builds a client request and sends it; T1 = micros() at send. The transmit
+ *    timestamp carries a per-request token that the server must echo as originate.
+ *  - poll(): non-blocking; on reply T4 = micros() at receive, T2/T3 from the packet
+ *    (with the 32-bit fraction), then
+ *      delay  = (T4 - T1) - (T3 - T2)
+ *      UTC at T4 = T3 + delay / 2        (== T4 + offset, offset = ((T2-T1)+(T3-T4))/2)
+ *    Retries on timeout up to `retries` times.
+ *  - sample(): UTC in µs paired with the local micros() at which it was valid, so callers
+ *    can project it to "now" without losing the sub-millisecond phase.
+ *
+ * Rejects: wrong mode, unsynchronized leap indicator, stratum 0 (kiss-o'-death) or > 15,
+ * zero transmit time, and originate mismatch (stale or spoofed replies).
+ */
+class SntpClient {
+public:
+  struct Config {
+    INtpTransport* transport = nullptr; ///< Required.
+    uint16_t       timeoutMs = 1200;    ///< Per-attempt reply timeout.
+    uint8_t        retries   = 2;       ///< Extra attempts after the first.
+  };
+
+  enum class State : uint8_t { Idle, Waiting, Done, Failed };
+
+  /// One completed exchange.
+  struct Sample {
+    uint64_t unixUs  = 0;   ///< Server UTC (µs since 1970) at local time localUs
+    uint32_t localUs = 0;   ///< micros() at reception (T4)
+    int32_t  delayUs = 0;   ///< Round-trip delay excluding server processing
+    uint8_t  stratum = 0;   ///< Server stratum (1..15)
+  };
+
+  SntpClient() = default;
+  explicit SntpClient(const Config& cfg) : cfg_(cfg) {}
+
+  void setConfig(const Config& cfg) { cfg_ = cfg; }
+
+  /// Begin an exchange; false if no transport or the first send failed.
+  bool start();
+
+  /// Advance the exchange (non-blocking); returns the current state.
+  State poll();
+
+  State state() const { return state_; }
+
+  /// Last successful sample (valid when state() == Done).
+  const Sample& sample() const { return sample_; }
+
+private:
+  static constexpr uint8_t  kPacketLen       = 48;
+  static constexpr uint32_t kNtpToUnixOffset = 2208988800UL; // 1900-01-01 → 1970-01-01
+
+  bool send_();
+  bool parse_(const uint8_t* p, uint32_t t4);
+
+  static uint64_t readTs_(const uint8_t* p);                 // big-endian 64-bit timestamp
+  static uint64_t ntpTsToUnixUs_(uint64_t ts);               // NTP era 0/1 → UNIX µs
+
+  Config   cfg_;
+  State    state_    = State::Idle;
+  uint8_t  attempt_  = 0;
+  uint32_t sentMs_   = 0;   // millis() at the last send (timeout)
+  uint32_t t1Us_     = 0;   // micros() at the last send
+  uint64_t token_    = 0;   // transmit timestamp we sent; must come back as originate
+  uint32_t tokenSeq_ = 0;
+  Sample   sample_;
+};
+
+}
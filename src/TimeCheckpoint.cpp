@@ -0,0 +1,91 @@
+#include "TimeCheckpoint.h"
+
+namespace sunlix {
+
+static void put16_(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+static void put32_(uint8_t* p, uint32_t v) { put16_(p, uint16_t(v)); put16_(p + 2, uint16_t(v >> 16)); }
+static uint16_t get16_(const uint8_t* p) { return uint16_t(p[0] | (uint16_t(p[1]) << 8)); }
+static uint32_t get32_(const uint8_t* p) { return get16_(p) | (uint32_t(get16_(p + 2)) << 16); }
+
+uint16_t TimeCheckpoint::crc16_(const uint8_t* p, uint16_t len) {
+  uint16_t crc = 0xFFFF;
+  while (len--) {
+    crc ^= static_cast<uint16_t>(*p++) << 8;
+    for (uint8_t b = 0; b < 8; ++b) crc = (crc & 0x8000) ? uint16_t((crc << 1) ^ 0x1021) : uint16_t(crc << 1);
+  }
+  return crc;
+}
+
+uint16_t TimeCheckpoint::slots_() const {
+  return store_ ? static_cast<uint16_t>(store_->size() / kSlotSize) : 0;
+}
+
+bool TimeCheckpoint::readSlot_(uint16_t i, uint32_t& seq, Data& out) {
+  uint8_t b[kSlotSize];
+  if (!store_->read(static_cast<uint16_t>(i * kSlotSize), b, kSlotSize)) return false;
+  if (get16_(b) != kMagic || get16_(b + 22) != crc16_(b, 22)) return false;
+
+  seq               = get32_(b + 2);
+  out.unixSec       = get32_(b + 6);
+  out.uptimeCorrPpb = static_cast<int32_t>(get32_(b + 10));
+  out.discFreqPpb   = static_cast<int32_t>(get32_(b + 14));
+  out.rtcPeriodUs   = get32_(b + 18);
+  return true;
+}
+
+void TimeCheckpoint::scan_() {
+  scanned_ = true;
+  valid_   = false;
+  seq_     = 0;
+
+  const uint16_t n = slots_();
+  for (uint16_t i = 0; i < n; ++i) {
+    uint32_t s;
+    Data d;
+    if (!readSlot_(i, s, d)) continue;
+    // Wrap-safe "newer than" so the ring keeps working past 2^32 writes
+    if (!valid_ || static_cast<int32_t>(s - seq_) > 0) {
+      valid_  = true;
+      slot_   = i;
+      seq_    = s;
+      newest_ = d;
+    }
+  }
+}
+
+bool TimeCheckpoint::load(Data& out) {
+  if (!store_) return false;
+  if (!scanned_) scan_();
+  if (!valid_) return false;
+  out = newest_;
+  return true;
+}
+
+bool TimeCheckpoint::save(const Data& d) {
+  const uint16_t n = slots_();
+  if (n == 0) return false;
+  if (!scanned_) scan_();
+
+  const uint16_t slot = valid_ ? static_cast<uint16_t>((slot_ + 1) % n) : 0;
+  const uint32_t seq  = seq_ + 1;
+
+  uint8_t b[kSlotSize];
+  put16_(b, kMagic);
+  put32_(b + 2, seq);
+  put32_(b + 6, d.unixSec);
+  put32_(b + 10, static_cast<uint32_t>(d.uptimeCorrPpb));
+  put32_(b + 14, static_cast<uint32_t>(d.discFreqPpb));
+  put32_(b + 18, d.rtcPeriodUs);
+  put16_(b + 22, crc16_(b, 22));
+
+  if (!store_->write(static_cast<uint16_t>(slot * kSlotSize), b, kSlotSize) || !store_->commit()) {
+    return false;
+  }
+  valid_  = true;
+  slot_   = slot;
+  seq_    = seq;
+  newest_ = d;
+  return true;
+}
+
+}
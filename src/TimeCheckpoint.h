@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include "INvStore.h"
+
+namespace sunlix {
+
+/**
+ * @class TimeCheckpoint
+ * @brief Wear-levelled ring of calibration/time checkpoints in an INvStore.
+ *
+ * Layout: the store is split into size()/kSlotSize slots of 24 bytes
+ *   magic(2) seq(4) unixSec(4) uptimeCorrPpb(4) discFreqPpb(4) rtcPeriodUs(4) crc16(2)
+ * little-endian, CRC-16/CCITT over everything before it.
+ *  - save() writes the slot after the newest one with seq + 1, so writes rotate over all
+ *    slots and a torn write only loses that checkpoint (the previous one stays valid).
+ *  - load() scans every slot and returns the valid one with the highest seq.
+ *
+ * Rate limiting is the caller's job (TimeService: Config::checkpointIntervalS).
+ */
+class TimeCheckpoint {
+public:
+  static constexpr uint16_t kSlotSize = 24;
+  static constexpr uint16_t kMagic    = 0x5443;  // "TC"
+
+  /// What is persisted; 0 means "unknown" for every field.
+  struct Data {
+    uint32_t unixSec       = 0;  ///< Last good UTC second
+    int32_t  uptimeCorrPpb = 0;  ///< Uptime provider millis() rate correction
+    int32_t  discFreqPpb   = 0;  ///< Clock discipline frequency
+    uint32_t rtcPeriodUs   = 0;  ///< Measured SQW period (micros() per RTC second)
+  };
+
+  explicit TimeCheckpoint(INvStore* store = nullptr) : store_(store) {}
+
+  void setStore(INvStore* store) { store_ = store; scanned_ = false; }
+
+  /// Newest valid checkpoint; false if none (fresh or corrupt store).
+  bool load(Data& out);
+
+  /// Append a checkpoint to the ring and commit; false without store or on write error.
+  bool save(const Data& d);
+
+  /// Sequence number of the newest checkpoint (0 if none).
+  uint32_t seq() const { return seq_; }
+
+private:
+  uint16_t slots_() const;
+  bool     readSlot_(uint16_t i, uint32_t& seq, Data& out);
+  void     scan_();
+
+  static uint16_t crc16_(const uint8_t* p, uint16_t len);
+
+  INvStore* store_   = nullptr;
+  bool      scanned_ = false;
+  bool      valid_   = false;  // a valid checkpoint exists (newest in slot_)
+  uint16_t  slot_    = 0;
+  uint32_t  seq_     = 0;
+  Data      newest_;
+};
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * @file TimeHal.h
+ * @brief Single hardware entry point for the library sources.
+ *
+ * Notes:
+ *  - On boards this is just Arduino + RTClib.
+ *  - With SUNLIX_TIME_HOST defined, the same names (millis(), micros(), attachInterrupt(),
+ *    RTC_DS3231, ::DateTime, ...) come from the host simulation in hal/HostArduino.h,
+ *    so providers and TimeService build unchanged on a workstation. The top-level
+ *    CMakeLists.txt builds that host library and the tests under tests/:
+ *      cmake -S . -B build && cmake --build build -j && ctest --test-dir build
+ */
+
+#if defined(SUNLIX_TIME_HOST)
+#include "hal/HostArduino.h"
+#else
+#include <Arduino.h>
+#include <Wire.h>
+#include <RTClib.h>
+#endif
@@ -1,9 +1,29 @@
+#include <new>
 #include "TimeService.h"
+#include "CivilTime.h"
+#include "UptimeClock.h"
 
 namespace sunlix {
 
+// Spread every input bit over the whole word (MurmurHash3 finaliser).
+static uint32_t mix32_(uint32_t x) {
+  x ^= x >> 16; x *= 0x85EBCA6BUL;
+  x ^= x >> 13; x *= 0xC2B2AE35UL;
+  return x ^ (x >> 16);
+}
+
 TimeService::TimeService(const Config& cfg)
-: cfg_(cfg) {}
+: cfg_(cfg), core_(nullptr, &uptimeProv_) {
+  ClockDiscipline::Config dc;
+  dc.maxSlewPpm = cfg_.maxSlewPpm;
+  disc_.setConfig(dc);
+  uptimeProv_.setCorrectionPpb(cfg_.uptimeCorrectionPpb);
+  ckpt_.setStore(cfg_.nvStore);
+}
+
+TimeService::~TimeService() {
+  if (rtcProv_) rtcProv_->~RtcDateTimeProvider();
+}
 
 bool TimeService::makeRtcProvider_() {
   if (!cfg_.rtc) return false;
@@ -14,77 +34,531 @@ bool TimeService::makeRtcProvider_() {
     rc.sqwPin        = cfg_.sqwPin;
     rc.sqwEdge       = cfg_.sqwEdge;
     rc.enableSqw1Hz  = cfg_.enableSqw1Hz;
+    rc.sqwHz         = cfg_.sqwHz;
+    rc.capture       = cfg_.sqwCapture;
+    rc.wire          = cfg_.rtcWire;
     rc.bindTimeoutMs = cfg_.bindTimeoutMs;
     rc.requireBind   = cfg_.requireBind;
-    rtcProv_ = new RtcDateTimeProvider(rc);
-  }
-
-  if (!rtcProv_->begin()) {
-    return false; // leave allocated but inactive
+    rc.asyncBind     = cfg_.asyncBind;
+    rtcProv_ = new (rtcStorage_) RtcDateTimeProvider(rc); // in-object storage, no heap
+    core_.provider<kRtcIdx>() = rtcProv_;
   }
-
-  active_     = rtcProv_;
-  activeKind_ = ActiveProvider::Rtc;
   return true;
 }
 
-void TimeService::makeUptimeProvider_() {
-  (void)uptimeProv_.begin();
-  active_     = &uptimeProv_;
-  activeKind_ = ActiveProvider::Uptime;
-}
-
 bool TimeService::begin() {
-  // Choose provider once
-  if (!makeRtcProvider_()) {
-    makeUptimeProvider_();
+  // Choose provider once: RTC first (if configured), else Uptime (always succeeds)
+  (void)makeRtcProvider_();
+  (void)core_.begin();
+  restoreCheckpoint_();
+  if (rtcProv_) {
+    edgeSeen_   = rtcProv_->edgeCount();   // the SQW watchdog starts now, not at millis() 0
+    edgeSeenMs_ = millis();
+  }
+
+  // Scheduler: first sync after a random 0..jitter s. Boards powered up together reach this
+  // at the same micros(), so the per-device seed and the restored/RTC time are mixed in.
+  if (cfg_.ntpAutoSync) {
+    ntpIntervalS_ = ntpMinIntervalS_();
+    uint32_t jitterMs = 0;
+    if (cfg_.ntpFirstSyncJitterS) {
+      uint64_t nowMs = 0;
+      (void)nowUnixMs(nowMs);
+      const uint32_t r = mix32_(mix32_(cfg_.ntpJitterSeed ^ static_cast<uint32_t>(nowMs)) ^ micros());
+      jitterMs = static_cast<uint32_t>((static_cast<uint64_t>(r) * cfg_.ntpFirstSyncJitterS * 1000U) >> 32);
+    }
+    ntpNextMs_ = millis() + jitterMs;
   }
 
-  // Optional NTP on begin
-  if (cfg_.ntpOnBegin && cfg_.ntpFetchUtc) {
+  // Optional NTP on begin (async fetch: only started here, finished by poll())
+  if (cfg_.ntpOnBegin && (cfg_.ntpFetchAsync || usesTransport_())) {
+    (void)ntpSyncStart();
+  } else if (cfg_.ntpOnBegin && cfg_.ntpFetchUtc) {
     (void)ntpSync(); // ignore failure; caller can query telemetry
   }
 
-  return (active_ != nullptr);
+  return (core_.activeIndex() != Core::kNone);
+}
+
+TimeService::ActiveProvider TimeService::activeProvider() const {
+  switch (core_.activeIndex()) {
+    case kRtcIdx:    return ActiveProvider::Rtc;
+    case kUptimeIdx: return ActiveProvider::Uptime;
+    default:         return ActiveProvider::None;
+  }
 }
 
 bool TimeService::nowUtc(DateTime& out) {
-  if (!active_) return false;
-  return active_->nowUtc(out);
+  if (!corrected_()) return core_.nowUtc(out);
+  uint64_t prov, us;
+  if (!readDisciplined_(prov, us)) return false;
+  cache_.getMs(us / 1000U, out);
+  return true;
+}
+
+bool TimeService::nowUnixMs(std::uint64_t& out) {
+  if (!corrected_()) return core_.nowUnixMs(out);
+  uint64_t prov, us;
+  if (!readDisciplined_(prov, us)) return false;
+  out = us / 1000U;
+  return true;
+}
+
+bool TimeService::nowUnixUs(std::uint64_t& out) {
+  if (!corrected_()) return core_.nowUnixUs(out);
+  uint64_t prov;
+  return readDisciplined_(prov, out);
+}
+
+// Provider time and the reported (provider + correction) time at the same instant.
+bool TimeService::readDisciplined_(uint64_t& provUs, uint64_t& outUs) {
+  if (!core_.nowUnixUs(provUs)) return false;
+  outUs = provUs + static_cast<uint64_t>(disc_.correctionUs(provUs));
+  return true;
 }
 
 bool TimeService::adjust(const DateTime& t) {
-  if (!active_) return false;
-  return active_->adjust(t);
+  if (!core_.adjust(t)) return false;
+  disc_.reset(civil::toUnixMs(t) * 1000U, cfg_.discipline); // explicit time: drop phase
+  return true;
 }
 
 TimeStatus TimeService::status() const {
-  if (!active_) return TimeStatus::NotStarted;
-  return active_->status();
+  return core_.status();
 }
 
 bool TimeService::ntpSync() {
-  if (!cfg_.ntpFetchUtc || !active_) return false;
+  if (!ntpSyncStart()) return false;
+
+  while (ntpRunning_()) {
+    const NtpStep st = ntpSyncPoll();
+    if (st == NtpStep::Request || st == NtpStep::Rebind) delay(1); // waiting on network / SQW
+  }
+  return ntpStep_ == NtpStep::Done;
+}
+
+bool TimeService::ntpSyncStart() {
+  if (!hasNtpSource_() || core_.activeIndex() == Core::kNone) return false;
+  if (ntpRunning_()) return false;
 
   ntpLastAttemptMs_ = millis();
+  ntpStep_ = NtpStep::Request;
+  ntpFilter_.clear();
+  ntpSelector_.clear();
+  ntpSrc_ = 0;
+  ntpReqStartUs_ = micros();
+
+  // Built-in SNTP client: send the request now, collect the reply in ntpSyncPoll()
+  if (!cfg_.ntpFetchAsync && usesTransport_() && !ntpStartServer_()) {
+    (void)ntpFinish_(false);
+    return false;
+  }
+  return true;
+}
+
+TimeService::NtpStep TimeService::ntpSyncPoll() {
+  switch (ntpStep_) {
+    case NtpStep::Request: {
+      if (!cfg_.ntpFetchAsync && usesTransport_()) {
+        const SntpClient::State st = sntp_.poll();
+        if (st == SntpClient::State::Waiting) return ntpStep_;
+        if (st != SntpClient::State::Done) return ntpSourceDone_(); // keep a partial burst
+        const SntpClient::Sample& sm = sntp_.sample();
+        return ntpSampleDone_(sm.unixUs, sm.localUs, sm.delayUs);
+      }
+
+      DateTime fetched{};
+      NtpResult r;
+      if (cfg_.ntpFetchAsync) {
+        r = cfg_.ntpFetchAsync(fetched);
+      } else {
+        r = cfg_.ntpFetchUtc(fetched) ? NtpResult::Ok : NtpResult::Fail;
+      }
+      if (r == NtpResult::Pending) return ntpStep_;
+      if (r == NtpResult::Fail) return ntpSourceDone_();
+      // Callbacks report no T1..T4: the time spent obtaining the answer bounds its delay
+      const uint32_t nowUs = micros();
+      return ntpSampleDone_(civil::toUnixMs(fetched) * 1000U, nowUs,
+                            static_cast<int32_t>(nowUs - ntpReqStartUs_));
+    }
+
+    case NtpStep::Apply: {
+      // Project the selected reference to now (covers loop() latency since it was sampled)
+      const uint64_t nowUs = ntpRefUnixUs_ + static_cast<uint32_t>(micros() - ntpRefLocalUs_);
+      // An unreadable provider leaves the offset unknown, not at the last sync's value
+      uint64_t provUs = 0, localUs = 0;
+      ntpOffsetValid_ = readDisciplined_(provUs, localUs);
+      if (ntpOffsetValid_) {
+        if (!corrected_()) localUs = provUs;
+        ntpLastOffsetUs_ = static_cast<int64_t>(nowUs - localUs);
+      } else {
+        ntpLastOffsetUs_ = 0;
+      }
+
+      // Discipline: slew small offsets in; no provider write, no re-bind
+      const int64_t absOff = ntpLastOffsetUs_ < 0 ? -ntpLastOffsetUs_ : ntpLastOffsetUs_;
+      if (disciplined_() && ntpOffsetValid_
+          && absOff < static_cast<int64_t>(cfg_.stepThresholdMs) * 1000) {
+        disc_.update(ntpLastOffsetUs_, provUs);
+        return ntpFinish_(true);
+      }
+
+      // Step the active provider: the RTC provider writes the DS3231 when the next whole
+      // second of nowUs begins and re-binds (non-blocking, sub-second phase kept); the
+      // uptime provider learns its drift from successive trusted steps
+      bool stepped = false;
+      if (core_.activeIndex() == kRtcIdx) {
+        stepped = rtcProv_->startAdjustUs(nowUs);
+      } else {
+        DateTime t{};
+        civil::fromUnixMs(nowUs / 1000U, t);
+        stepped = uptimeProv_.adjustTrusted(t);
+      }
+      if (!stepped) return ntpFinish_(false);
+      disc_.reset(nowUs, cfg_.discipline);  // keep the learned/restored rate in discipline mode
+      goodUnixUs_  = nowUs;                 // failover during the re-bind continues from here
+      goodLocalUs_ = uptime::micros64();
+
+      if (core_.activeIndex() == kRtcIdx
+          && rtcProv_->bindState() == RtcDateTimeProvider::BindState::Pending) {
+        ntpStep_ = NtpStep::Rebind;
+        return ntpStep_;
+      }
+      return ntpFinish_(true);
+    }
+
+    case NtpStep::Rebind: {
+      if (core_.activeIndex() != kRtcIdx) return ntpFinish_(false);   // failed over meanwhile
+      switch (rtcProv_->poll()) {
+        case RtcDateTimeProvider::BindState::Pending:  return ntpStep_;
+        case RtcDateTimeProvider::BindState::Bound:    return ntpFinish_(true);
+        default:                                       return ntpFinish_(!cfg_.requireBind);
+      }
+    }
+
+    default:
+      return ntpStep_;
+  }
+}
+
+// Record one sample in the clock filter; start the next burst request or move to Apply.
+TimeService::NtpStep TimeService::ntpSampleDone_(uint64_t unixUs, uint32_t localUs, int32_t delayUs) {
+  NtpClockFilter::Entry e;
+  e.refUnixUs  = unixUs;
+  e.refLocalUs = localUs;
+  e.delayUs    = delayUs;
+
+  // Offset vs. the active provider at the sample's local time (telemetry)
+  uint64_t provUs = 0;
+  if (core_.nowUnixUs(provUs)) {
+    provUs  -= static_cast<uint32_t>(micros() - localUs);
+    e.offsetUs = static_cast<int64_t>(unixUs - provUs);
+  }
+  ntpFilter_.add(e);
+
+  const uint8_t burst = (cfg_.ntpBurst == 0) ? 1
+                      : (cfg_.ntpBurst > NtpClockFilter::kSize ? NtpClockFilter::kSize : cfg_.ntpBurst);
+  if (ntpFilter_.count() < burst) {
+    ntpReqStartUs_ = micros();
+    if (cfg_.ntpFetchAsync || !usesTransport_() || sntp_.start()) return ntpStep_; // next request
+  }
+  return ntpSourceDone_();
+}
+
+// Current source finished its burst: keep its best sample, then move to the next server.
+TimeService::NtpStep TimeService::ntpSourceDone_() {
+  const int8_t b = ntpFilter_.best();
+  if (b >= 0) {
+    const NtpClockFilter::Entry& e = ntpFilter_.entry(static_cast<uint8_t>(b));
+    if (ntpSelector_.count() == 0) {
+      // First answer sets the common reference all candidates are expressed against
+      ntpRefUnixUs_  = e.refUnixUs;
+      ntpRefLocalUs_ = e.refLocalUs;
+    }
+    NtpSelector::Candidate c;
+    c.offsetUs = static_cast<int64_t>(e.refUnixUs - ntpRefUnixUs_)
+               + static_cast<int32_t>(ntpRefLocalUs_ - e.refLocalUs);
+    c.delayUs  = e.delayUs;
+    (void)ntpSelector_.add(c);
+  }
+
+  ++ntpSrc_;
+  if (!cfg_.ntpFetchAsync && usesTransport_() && ntpStartServer_()) return ntpStep_;
+
+  // All sources done: intersect, reject falsetickers, combine survivors
+  int64_t off = 0;
+  if (!ntpSelector_.select(ntpSourceCount_(), off, ntpLastDelayUs_)) return ntpFinish_(false);
+  ntpRefUnixUs_ += static_cast<uint64_t>(off);
+  ntpStep_ = NtpStep::Apply;
+  return ntpStep_;
+}
+
+// Send the first request to server ntpSrc_, skipping servers that cannot send.
+bool TimeService::ntpStartServer_() {
+  const uint8_t n = ntpSourceCount_();
+  for (; ntpSrc_ < n; ++ntpSrc_) {
+    SntpClient::Config sc;
+    sc.transport = ntpServer_(ntpSrc_);
+    sc.timeoutMs = cfg_.ntpTimeoutMs;
+    sc.retries   = cfg_.ntpRetries;
+    sntp_.setConfig(sc);
+    ntpFilter_.clear();
+    ntpReqStartUs_ = micros();
+    if (sntp_.start()) return true;
+  }
+  return false;
+}
 
-  DateTime ntp{};
-  bool ok = cfg_.ntpFetchUtc(ntp);
+// Servers in use: the ntpServers list if any entry is set, else the single ntpTransport.
+INtpTransport* TimeService::ntpServer_(uint8_t i) const {
+  uint8_t k = 0;
+  for (INtpTransport* t : cfg_.ntpServers) {
+    if (t && k++ == i) return t;
+  }
+  return (k == 0 && i == 0) ? cfg_.ntpTransport : nullptr;
+}
+
+uint8_t TimeService::ntpSourceCount_() const {
+  if (cfg_.ntpFetchAsync || !usesTransport_()) return 1;
+  uint8_t k = 0;
+  for (INtpTransport* t : cfg_.ntpServers) if (t) ++k;
+  return k ? k : 1;
+}
+
+TimeService::NtpStep TimeService::ntpFinish_(bool ok) {
+  if (cfg_.ntpAutoSync) ntpSchedule_(ok); // before ntpEverSynced_ changes
   ntpLastOk_ = ok;
+  if (ok) {
+    ntpEverSynced_    = true;
+    ntpLastSuccessMs_ = ntpLastAttemptMs_;
+  }
+  ntpStep_ = ok ? NtpStep::Done : NtpStep::Failed;
+  if (ok) (void)checkpoint();   // rate-limited by checkpointIntervalS
+  return ntpStep_;
+}
+
+// Pick the next sync time from the outcome of the one just finished.
+void TimeService::ntpSchedule_(bool ok) {
+  static constexpr uint32_t kBackoffBaseS = 16;
+  const uint32_t lo = ntpMinIntervalS_();
+  const uint32_t hi = ntpMaxIntervalS_();
+  uint32_t waitS;
 
   if (!ok) {
-    return false;
+    // Exponential backoff, independent of the (kept) poll interval
+    if (ntpFailures_ < 31) ++ntpFailures_;
+    waitS = (ntpFailures_ > 12) ? hi : (kBackoffBaseS << (ntpFailures_ - 1));
+    if (waitS > hi) waitS = hi;
+  } else {
+    ntpFailures_ = 0;
+    // The offset corrected now is the error accumulated over the last interval
+    const int64_t  off   = ntpLastOffsetUs_ < 0 ? -ntpLastOffsetUs_ : ntpLastOffsetUs_;
+    const uint64_t tgtUs = static_cast<uint64_t>(cfg_.ntpTargetOffsetMs) * 1000U;
+    if (!ntpEverSynced_) {
+      ntpIntervalS_ = lo;                       // first fix: offset says nothing about drift
+    } else if (!ntpOffsetValid_) {
+      // provider unreadable at Apply: no drift information, keep the interval
+    } else if (static_cast<uint64_t>(off) > tgtUs) {
+      ntpIntervalS_ /= 2;
+    } else if (static_cast<uint64_t>(off) * 4 <= tgtUs && ntpIntervalS_ <= hi / 2) {
+      ntpIntervalS_ *= 2;
+    }
+    if (ntpIntervalS_ < lo) ntpIntervalS_ = lo;
+    if (ntpIntervalS_ > hi) ntpIntervalS_ = hi;
+    waitS = ntpIntervalS_;
   }
+  ntpNextMs_ = millis() + waitS * 1000U;
+}
 
-  // Apply to active provider (RTC provider will also write seconds to DS3231 and re-bind)
-  if (!active_->adjust(ntp)) {
-    ntpLastOk_ = false;
-    return false;
+uint32_t TimeService::ntpMinIntervalS_() const {
+  if (cfg_.ntpMinIntervalS) return cfg_.ntpMinIntervalS;
+  return (core_.activeIndex() == kRtcIdx) ? 1024U : 64U;
+}
+
+uint32_t TimeService::ntpMaxIntervalS_() const {
+  uint32_t hi = cfg_.ntpMaxIntervalS;
+  if (!hi) hi = (core_.activeIndex() == kRtcIdx) ? 65536U : 2048U;
+  const uint32_t lo = ntpMinIntervalS_();
+  return hi < lo ? lo : hi;
+}
+
+// Warm boot: reload calibration and, without an RTC, the last good time.
+void TimeService::restoreCheckpoint_() {
+  TimeCheckpoint::Data d;
+  if (!ckpt_.load(d)) return;
+
+  ckptUnixSec_ = d.unixSec;
+  if (d.uptimeCorrPpb) uptimeProv_.setCorrectionPpb(d.uptimeCorrPpb); // newer than the preload
+  if (d.rtcPeriodUs && rtcProv_) (void)rtcProv_->setPeriodUs(d.rtcPeriodUs);
+
+  if (core_.activeIndex() == kUptimeIdx && d.unixSec) {
+    DateTime t{};
+    civil::fromUnix(d.unixSec, t);
+    (void)uptimeProv_.adjust(t);   // not trusted: no drift learning from a stale time
+  }
+
+  // Learned rate (discipline mode only): anchor it at the provider's time now, if it has one;
+  // otherwise it waits for the first step, which anchors it and keeps it
+  if (d.discFreqPpb && cfg_.discipline) {
+    disc_.setFreqPpb(d.discFreqPpb);
+    uint64_t provUs = 0;
+    if (core_.nowUnixUs(provUs) && provUs != 0) disc_.reset(provUs, true);
+  }
+}
+
+bool TimeService::checkpoint(bool force) {
+  if (!cfg_.nvStore) return false;
+  if (!force && ckptWritten_
+      && millis() - ckptLastMs_ < cfg_.checkpointIntervalS * 1000UL) return false;
+
+  // Only a time that came from NTP or a running RTC is worth restoring later
+  if (ntpEverSynced_ || core_.activeIndex() == kRtcIdx) {
+    uint64_t ms = 0;
+    if (nowUnixMs(ms)) ckptUnixSec_ = static_cast<uint32_t>(ms / 1000U);
   }
 
-  ntpEverSynced_  = true;
-  ntpLastSuccessMs_ = ntpLastAttemptMs_;
+  TimeCheckpoint::Data d;
+  d.unixSec       = ckptUnixSec_;
+  d.uptimeCorrPpb = uptimeProv_.correctionPpb();
+  d.discFreqPpb   = disc_.freqPpb();
+  d.rtcPeriodUs   = (rtcProv_ && rtcProv_->hasMeasuredPeriod()) ? rtcProv_->measuredPeriodUs() : 0;
+
+  if (!ckpt_.save(d)) return false;
+  ckptLastMs_  = millis();
+  ckptWritten_ = true;
   return true;
 }
 
-}
\ No newline at end of file
+void TimeService::poll() {
+  uptime::poll();   // a stopped SQW with no reads must not hide a micros() wrap
+
+  // Health first: a sync waiting on the RTC (Rebind) must not keep a dead RTC in use
+  if (cfg_.failover && rtcProv_
+      && static_cast<uint32_t>(millis() - healthLastMs_) >= cfg_.healthCheckMs) {
+    healthLastMs_ = millis();
+    checkHealth_();
+  }
+
+  if (ntpRunning_()) {
+    (void)ntpSyncPoll();   // also drives the RTC re-bind while in NtpStep::Rebind
+    return;
+  }
+
+  if (cfg_.ntpAutoSync && static_cast<int32_t>(millis() - ntpNextMs_) >= 0) {
+    if (!hasNtpSource_() || core_.activeIndex() == Core::kNone) {
+      ntpSchedule_(false);   // nothing to sync: back off instead of retrying every loop()
+    } else {
+      (void)ntpSyncStart();  // a failed start is rescheduled by ntpFinish_()
+    }
+    return;
+  }
+
+  if (core_.activeIndex() == kRtcIdx || rtcRebinding_) {
+    (void)rtcProv_->poll();
+    if (rtcRebinding_) returnToRtc_();
+  }
+}
+
+// Failover monitor: I2C probe + SQW liveness for the RTC in use, or its recovery.
+void TimeService::checkHealth_() {
+  const uint32_t edges = rtcProv_->edgeCount();
+  const bool     fresh = (edges != edgeSeen_);
+  if (fresh) {
+    edgeSeen_   = edges;
+    edgeSeenMs_ = millis();
+  }
+
+  if (!rtcFailed_) {
+    if (core_.activeIndex() != kRtcIdx) return;
+    // Edges are only expected once bound or while a bind waits for them (a soft start that
+    // timed out may run seconds-only)
+    const bool expectEdges = rtcProv_->isBound()
+                          || rtcProv_->bindState() == RtcDateTimeProvider::BindState::Pending;
+    const bool stalled = expectEdges
+                      && static_cast<uint32_t>(millis() - edgeSeenMs_) >= cfg_.failoverAfterMs;
+    if (stalled || !rtcProv_->probe()) {
+      failToUptime_();
+    } else {
+      // Remember a known-good reading in case the next failure leaves nothing to read
+      uint64_t prov = 0, us = 0;
+      if (readDisciplined_(prov, us)) {
+        goodUnixUs_  = corrected_() ? us : prov;
+        goodLocalUs_ = uptime::micros64();
+      }
+    }
+    return;
+  }
+
+  // Failed over: need a responding chip and edges on a few consecutive checks
+  if (rtcRebinding_) return;
+  edgesBack_ = (fresh && rtcProv_->probe()) ? static_cast<uint8_t>(edgesBack_ + 1) : 0;
+  if (edgesBack_ >= 3) {
+    edgesBack_    = 0;
+    rtcRebinding_ = true;
+    rtcProv_->rebind();
+  }
+}
+
+// Hand over to the uptime provider at the current reported time (no jump).
+void TimeService::failToUptime_() {
+  // Continue from the last good reading (≤ healthCheckMs old): reading the RTC now may need
+  // the bus that just failed, or extrapolate from edges that stopped.
+  uint64_t prov = 0, us = 0;
+  if (goodUnixUs_ != 0) {
+    us = goodUnixUs_ + (uptime::micros64() - goodLocalUs_);
+  } else {
+    if (!readDisciplined_(prov, us)) return;
+    if (!corrected_()) us = prov;
+  }
+
+  DateTime t{};
+  civil::fromUnixMs(us / 1000U, t);
+  (void)uptimeProv_.adjust(t);          // seeded, not trusted: no drift learning
+  disc_.reset(civil::toUnixMs(t) * 1000U, false);
+  (void)core_.setActive(kUptimeIdx);
+
+  rtcFailed_    = true;
+  rtcRewritten_ = false;
+  edgesBack_    = 0;
+  ++failovers_;
+}
+
+// Recovery: once the RTC is bound again, switch back and slew out the difference.
+void TimeService::returnToRtc_() {
+  switch (rtcProv_->bindState()) {
+    case RtcDateTimeProvider::BindState::Pending: return;
+    case RtcDateTimeProvider::BindState::Bound:   break;
+    default: rtcRebinding_ = false; return;       // timed out: keep watching
+  }
+  rtcRebinding_ = false;
+
+  uint64_t prov = 0, us = 0, rtcUs = 0;
+  if (!readDisciplined_(prov, us) || !rtcProv_->nowUnixUs(rtcUs)) return;
+  if (!corrected_()) us = prov;
+
+  const int64_t diff = static_cast<int64_t>(us - rtcUs);
+  const int64_t absDiff = diff < 0 ? -diff : diff;
+
+  // Lost its time meanwhile (brown-out: OSF set, or a jump no outage explains): write the
+  // uptime time to it and come back here once that is bound; a second time, stay on uptime
+  if (rtcProv_->lostPower() || absDiff >= static_cast<int64_t>(cfg_.failbackMaxDiffS) * 1000000) {
+    if (!rtcRewritten_ && rtcProv_->startAdjustUs(us)) {
+      rtcRewritten_ = true;
+      rtcRebinding_ = true;
+    }
+    return;
+  }
+
+  (void)core_.setActive(kRtcIdx);
+  rtcFailed_    = false;
+  rtcRewritten_ = false;
+  edgeSeenMs_   = millis();
+
+  if (absDiff < static_cast<int64_t>(cfg_.stepThresholdMs) * 1000) {
+    disc_.carry(diff, rtcUs);           // continuous: report uptime's time, converge to the RTC
+  } else {
+    disc_.reset(rtcUs, false);          // too far apart: trust the RTC
+  }
+}
+
+}
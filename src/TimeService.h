@@ -1,10 +1,16 @@
 #pragma once
-#include <Arduino.h>
-#include <RTClib.h>
+#include "TimeHal.h"
 
 #include "IDateTimeProvider.h"
 #include "RtcDateTimeProvider.h"
 #include "UptimeDateTimeProvider.h"
+#include "TimeServiceT.h"
+#include "SntpClient.h"
+#include "NtpClockFilter.h"
+#include "NtpSelector.h"
+#include "ClockDiscipline.h"
+#include "CalendarCache.h"
+#include "TimeCheckpoint.h"
 
 namespace sunlix {
 
@@ -17,75 +23,273 @@ namespace sunlix {
  *      1) Try RTC provider if RTC is provided in config.
  *      2) Else fall back to Uptime provider.
  *      3) Optionally run one-shot NTP sync (if callback provided).
- *  - nowUtc()/adjust(): delegated to the active provider.
- *  - ntpSync(): public helper to trigger NTP sync at any time.
+ *  - nowUtc()/nowUnixMs()/nowUnixUs()/adjust(): delegated to the active provider.
+ *  - ntpSync(): public helper to trigger NTP sync at any time (blocking).
+ *  - ntpSyncStart()/ntpSyncPoll(): the same sync as a non-blocking pipeline
+ *      Request → Apply → Rebind → Done/Failed, one step per call (poll() also drives it).
+ *      With ntpFetchAsync the request itself may return Pending across many loop() calls;
+ *      the fetched time is advanced by the micros() spent between fetch and apply.
+ *  - Clock filter: each sync collects ntpBurst samples (iburst-style, back to back) into a
+ *    fixed 8-entry register and applies only the lowest-delay one (see NtpClockFilter).
+ *  - NTP source, first configured wins: ntpFetchAsync, ntpServers/ntpTransport (built-in
+ *    SntpClient with delay compensation and sub-ms phase), ntpFetchUtc.
+ *  - Multiple servers (ntpServers, up to 4): each is sampled in turn (burst + clock filter),
+ *    then NtpSelector intersects their correctness intervals; the sync applies the combined
+ *    survivors only if a majority of the configured servers agree, else it fails untouched.
+ *  - poll(): advances background work; with asyncBind, begin()/ntpSync() do not wait for SQW.
+ *  - Discipline mode (discipline = true): after the first sync, NTP offsets below
+ *    stepThresholdMs are not applied with adjust() but slewed in (≤ maxSlewPpm) by a
+ *    ClockDiscipline whose FLL also learns the provider's rate error. The facade then reports
+ *    provider time + correction: monotonic, no gaps, and no DS3231 write or SQW re-bind.
+ *    Larger offsets (or adjust()) step the provider as before; the learned rate is kept.
+ *  - Failover (failover = true): every healthCheckMs poll() probes the DS3231's I2C address and
+ *    checks that SQW edges keep arriving. If either fails (no edge for failoverAfterMs) the
+ *    uptime provider is seeded with the current reported time and takes over: no jump.
+ *    When the RTC answers again and edges are back, it is re-bound and made active; the
+ *    difference to the uptime time is slewed out (stepped if above stepThresholdMs).
+ *    A chip that lost its time meanwhile (OSF set, or further than failbackMaxDiffS from the
+ *    uptime time) is not trusted: it is rewritten from the uptime time first, once.
+ *  - Checkpoints (nvStore): calibration (uptime ppb, discipline ppb, SQW period) and the last
+ *    good UTC second go to a wear-levelled TimeCheckpoint ring after each successful sync,
+ *    at most every checkpointIntervalS. begin() restores them, and an uptime-only boot starts
+ *    from the stored time instead of 2000-01-01 (late by the power-off time until NTP).
+ *  - Scheduler (ntpAutoSync): poll() starts syncs by itself. After a success the interval
+ *    doubles while |offset| stays under ntpTargetOffsetMs/4 and halves above ntpTargetOffsetMs,
+ *    within bounds that follow the active provider (RTC drifts ppm, uptime drifts far more).
+ *    Failures retry after 16 s, 32 s, ... up to the max interval. The first scheduled sync
+ *    is delayed by a random 0..ntpFirstSyncJitterS so a fleet does not hit the server at once;
+ *    the draw mixes micros(), the current time and ntpJitterSeed. Identical boards booted
+ *    together see the same micros() and time, so give each a distinct seed (chip ID / MAC).
+ *
+ * Memory: zero dynamic allocation; all providers live inside the TimeService object.
+ *
+ * Runtime wrapper over TimeServiceT<RtcDateTimeProvider, UptimeDateTimeProvider>: calls into
+ * the chosen provider are direct (non-virtual). Builds that only ever use one provider can
+ * use TimeServiceT<...> directly and drop the other.
  *
  * NTP telemetry you can query:
  *  - ntpEverSynced(): whether there has ever been a successful NTP sync.
  *  - ntpLastOk(): result of the last NTP attempt.
  *  - ntpLastAttemptMs(): millis() of the last attempt (0 if none).
  *  - ntpLastSuccessMs(): millis() of the last success (0 if none).
+ *  - ntpStep(): current step of the sync pipeline.
+ *  - rtcFailedOver(): running on uptime because the RTC failed; failoverCount(): switches so far.
+ *  - uptimeCorrectionPpb(): millis() rate correction the uptime provider uses (store it and
+ *    pass it back as Config::uptimeCorrectionPpb to start corrected).
+ *  - clockDiscipline(): learned frequency (ppb) and phase still being slewed.
+ *  - ntpIntervalS(): current sync interval; ntpFailures(): consecutive failed syncs.
+ *  - ntpFilter(): samples of the last server's burst; ntpSelector(): per-server candidates and
+ *    survivors of the last selection; ntpLastOffsetUs()/ntpLastDelayUs(): what was applied.
  */
 class TimeService final : public IDateTimeProvider {
 public:
   /// User-supplied NTP fetch function: must fill UTC time; return true on success.
   using NtpFetchFn = bool (*)(DateTime& outUtc);
 
+  /// Result of one call to a non-blocking NTP fetch function.
+  enum class NtpResult : uint8_t { Pending, Ok, Fail };
+
+  /// Non-blocking NTP fetch: start or continue the exchange; fill outUtc when returning Ok.
+  using NtpAsyncFetchFn = NtpResult (*)(DateTime& outUtc);
+
+  /// Step of the NTP sync pipeline.
+  enum class NtpStep : uint8_t {
+    Idle,     ///< no sync started yet
+    Request,  ///< waiting for the fetch function
+    Apply,    ///< time received; adjust the active provider next
+    Rebind,   ///< RTC write scheduled at the next whole second; waiting for it and the re-bind
+    Done,     ///< last sync succeeded
+    Failed    ///< last sync failed
+  };
+
   struct Config {
     // --- RTC (DS3231 SQW) ---
     RTC_DS3231* rtc           = nullptr;     ///< If non-null, RTC provider will be attempted.
+    TwoWire*    rtcWire       = nullptr;     ///< Bus the DS3231 is on, for health probes (nullptr = Wire).
     uint8_t     sqwPin        = 2;           ///< Interrupt-capable pin wired to DS3231 SQW.
     PinStatus   sqwEdge       = RISING;      ///< RISING or FALLING.
-    bool        enableSqw1Hz  = true;        ///< Program DS3231 to 1 Hz SQW on begin().
+    bool        enableSqw1Hz  = true;        ///< Program DS3231 SQW (rate = sqwHz) on begin().
+    uint16_t    sqwHz         = 1;           ///< 1, 1024, 4096 or 8192 (kHz = high-resolution mode).
+    ISqwCapture* sqwCapture   = nullptr;     ///< Hardware SQW edge timestamps (AvrTimer1SqwCapture, ...).
     uint16_t    bindTimeoutMs = 1500;        ///< Wait for next SQW edge (0 = infinite).
     bool        requireBind   = true;        ///< If true and timeout → RTC begin() fails.
+    bool        asyncBind     = false;       ///< Never block on SQW bind; call poll() from loop().
 
     // --- NTP (optional, callback-based) ---
     bool        ntpOnBegin    = true;        ///< Try NTP once inside begin() if callback provided.
     NtpFetchFn  ntpFetchUtc   = nullptr;     ///< User-provided NTP function (may be nullptr).
+    NtpAsyncFetchFn ntpFetchAsync = nullptr; ///< Non-blocking variant; preferred when set.
+
+    // --- NTP (optional, built-in SNTP client) ---
+    INtpTransport* ntpTransport = nullptr;   ///< Datagram transport to one NTP server.
+    INtpTransport* ntpServers[NtpSelector::kMaxSources] = {}; ///< Several servers (overrides ntpTransport).
+    uint16_t    ntpTimeoutMs  = 1200;        ///< Per-attempt reply timeout.
+    uint8_t     ntpRetries    = 2;           ///< Extra attempts after the first.
+    uint8_t     ntpBurst      = 1;           ///< Samples per sync (1..8); min-delay one applied.
+
+    // --- RTC health / failover ---
+    bool        failover        = false;     ///< Monitor the RTC and hot-swap to Uptime on failure.
+    uint16_t    healthCheckMs   = 1000;      ///< Interval of the I2C probe / SQW check.
+    uint16_t    failoverAfterMs = 2500;      ///< No SQW edge for this long = RTC failed.
+    uint32_t    failbackMaxDiffS = 3600;     ///< RTC this far from the uptime time on recovery = lost its time.
+
+    // --- Uptime fallback ---
+    int32_t     uptimeCorrectionPpb = 0;     ///< Preloaded millis() rate correction (learned on NTP).
+
+    // --- Clock discipline ---
+    bool        discipline      = false;     ///< Slew NTP corrections instead of stepping.
+    uint16_t    stepThresholdMs = 128;       ///< Offsets above this still step the provider.
+    uint16_t    maxSlewPpm      = 500;       ///< Phase slew rate limit.
+
+    // --- Persistence (optional) ---
+    INvStore*   nvStore       = nullptr;     ///< Checkpoint storage (EepromNvStore, ...).
+    uint32_t    checkpointIntervalS = 3600;  ///< Minimum spacing of automatic checkpoints.
+
+    // --- NTP scheduler (driven by poll()) ---
+    bool        ntpAutoSync   = false;       ///< Start syncs from poll() on an adaptive interval.
+    uint32_t    ntpMinIntervalS = 0;         ///< 0 = by provider (RTC 1024 s, Uptime 64 s).
+    uint32_t    ntpMaxIntervalS = 0;         ///< 0 = by provider (RTC 65536 s, Uptime 2048 s).
+    uint16_t    ntpTargetOffsetMs = 20;      ///< Offset per interval the scheduler aims to stay under.
+    uint16_t    ntpFirstSyncJitterS = 0;     ///< Random delay (0..N s) of the first scheduled sync.
+    uint32_t    ntpJitterSeed = 0;           ///< Per-device value for that delay (chip ID, MAC bytes).
   };
 
   explicit TimeService(const Config& cfg);
+  ~TimeService() override;
+
+  TimeService(const TimeService&) = delete;
+  TimeService& operator=(const TimeService&) = delete;
 
   // IDateTimeProvider
   bool begin() override;
   bool nowUtc(DateTime& out) override;
+  bool nowUnixMs(std::uint64_t& out) override;
+  bool nowUnixUs(std::uint64_t& out) override;
   bool adjust(const DateTime& t) override;
   TimeStatus status() const override;
 
   // Extra: trigger NTP sync manually.
   bool ntpSync();
 
+  /// Start a non-blocking NTP sync; false if no fetch function/provider or one is running.
+  bool ntpSyncStart();
+
+  /// Advance the running NTP sync by one step; returns the step reached.
+  NtpStep ntpSyncPoll();
+
+  /// Store calibration and the current time now (force) or if checkpointIntervalS has passed.
+  bool checkpoint(bool force = false);
+
+  /// Drive non-blocking background work (async SQW bind, NTP sync and scheduler, and
+  /// uptime::poll()); call from loop().
+  void poll();
+
   // Active provider kind.
   enum class ActiveProvider : uint8_t { None, Rtc, Uptime };
-  ActiveProvider activeProvider() const { return activeKind_; }
+  ActiveProvider activeProvider() const;
 
   // NTP telemetry
   bool     ntpEverSynced()   const { return ntpEverSynced_; }
   bool     ntpLastOk()       const { return ntpLastOk_; }
   uint32_t ntpLastAttemptMs()const { return ntpLastAttemptMs_; }
   uint32_t ntpLastSuccessMs()const { return ntpLastSuccessMs_; }
+  NtpStep  ntpStep()         const { return ntpStep_; }
+  uint32_t ntpIntervalS()    const { return ntpIntervalS_; }
+  const ClockDiscipline& clockDiscipline() const { return disc_; }
+  bool     rtcFailedOver()   const { return rtcFailed_; }
+  uint16_t failoverCount()   const { return failovers_; }
+  int32_t  uptimeCorrectionPpb() const { return uptimeProv_.correctionPpb(); } ///< learned/preloaded
+  uint8_t  ntpFailures()     const { return ntpFailures_; }
+  const NtpClockFilter& ntpFilter() const { return ntpFilter_; }
+  const NtpSelector&    ntpSelector() const { return ntpSelector_; }
+  int64_t  ntpLastOffsetUs() const { return ntpLastOffsetUs_; } ///< NTP - local at last apply
+  bool     ntpLastOffsetValid() const { return ntpOffsetValid_; } ///< false: provider unreadable then
+  int32_t  ntpLastDelayUs()  const { return ntpLastDelayUs_; }  ///< delay of that sample
 
 private:
-  bool makeRtcProvider_();    // instantiate & begin RTC provider (returns success)
-  void makeUptimeProvider_(); // begin uptime provider (always succeeds)
+  bool makeRtcProvider_();    // instantiate RTC provider if configured (returns presence)
+  bool ntpRunning_() const { return ntpStep_ == NtpStep::Request || ntpStep_ == NtpStep::Apply
+                                 || ntpStep_ == NtpStep::Rebind; }
+  NtpStep ntpFinish_(bool ok);
+  NtpStep ntpSampleDone_(uint64_t unixUs, uint32_t localUs, int32_t delayUs);
+  NtpStep ntpSourceDone_();
+  bool    ntpStartServer_();
+  INtpTransport* ntpServer_(uint8_t i) const;
+  uint8_t ntpSourceCount_() const;
+  void restoreCheckpoint_();
+  void checkHealth_();
+  void failToUptime_();
+  void returnToRtc_();
+  bool disciplined_() const { return cfg_.discipline && ntpEverSynced_; }
+  bool corrected_() const { return disciplined_() || disc_.active(); }
+  bool readDisciplined_(uint64_t& provUs, uint64_t& outUs);
+  void ntpSchedule_(bool ok);
+  uint32_t ntpMinIntervalS_() const;
+  uint32_t ntpMaxIntervalS_() const;
+  bool usesTransport_() const { return ntpServer_(0) != nullptr; }
+  bool hasNtpSource_() const { return cfg_.ntpFetchAsync || usesTransport_() || cfg_.ntpFetchUtc; }
+
+  using Core = TimeServiceT<RtcDateTimeProvider, UptimeDateTimeProvider>;
+  static constexpr uint8_t kRtcIdx    = 0;
+  static constexpr uint8_t kUptimeIdx = 1;
 
 private:
   Config cfg_;
 
-  // Concrete providers (allocated at most once)
-  RtcDateTimeProvider*    rtcProv_     = nullptr; // created via new when needed
+  // Concrete providers: no heap; the RTC provider is placement-constructed in
+  // rtcStorage_ only when an RTC is configured, so sizeof(TimeService) is fixed.
+  alignas(RtcDateTimeProvider) unsigned char rtcStorage_[sizeof(RtcDateTimeProvider)];
+  RtcDateTimeProvider*    rtcProv_     = nullptr; // points into rtcStorage_ once built
   UptimeDateTimeProvider  uptimeProv_;            // always available
 
-  // Delegation target
-  IDateTimeProvider* active_ = nullptr;
-  ActiveProvider     activeKind_ = ActiveProvider::None;
+  // Compile-time dispatch over the providers above (RTC first, Uptime fallback)
+  Core core_;
 
   // NTP state
   bool     ntpEverSynced_    = false;
   bool     ntpLastOk_        = false;
   uint32_t ntpLastAttemptMs_ = 0;
   uint32_t ntpLastSuccessMs_ = 0;
+
+  // NTP pipeline state
+  NtpStep  ntpStep_          = NtpStep::Idle;
+  uint32_t ntpReqStartUs_    = 0;  // micros() when the current request began
+  uint64_t ntpRefUnixUs_     = 0;  // selected UTC (µs since 1970) ...
+  uint32_t ntpRefLocalUs_    = 0;  // ... valid at this micros()
+  uint8_t  ntpSrc_           = 0;  // server being sampled
+  int64_t  ntpLastOffsetUs_  = 0;
+  bool     ntpOffsetValid_   = false;
+  int32_t  ntpLastDelayUs_   = 0;
+  NtpClockFilter ntpFilter_;       // samples of the current/last burst
+  NtpSelector    ntpSelector_;     // one candidate per answering server
+
+  // Clock discipline (active once a first sync has stepped the provider)
+  ClockDiscipline disc_;
+  CalendarCache   cache_;
+
+  // RTC health / failover
+  uint32_t healthLastMs_    = 0;     // millis() of the last health check
+  uint32_t edgeSeen_        = 0;     // edgeCount() at the last check ...
+  uint32_t edgeSeenMs_      = 0;     // ... and when it last advanced
+  uint8_t  edgesBack_       = 0;     // consecutive checks with fresh edges (recovery)
+  bool     rtcFailed_       = false;
+  bool     rtcRebinding_    = false; // recovery: waiting for the re-bind
+  bool     rtcRewritten_    = false; // recovery: RTC rewritten from the uptime time
+  uint16_t failovers_       = 0;
+  uint64_t goodUnixUs_      = 0;     // last reported time while the RTC was healthy ...
+  uint64_t goodLocalUs_     = 0;     // ... at this uptime::micros64()
+
+  // Persistence
+  TimeCheckpoint ckpt_;
+  uint32_t ckptLastMs_      = 0;     // millis() of the last checkpoint written
+  bool     ckptWritten_     = false;
+  uint32_t ckptUnixSec_     = 0;     // last good time known to the store
+
+  // NTP scheduler state
+  uint32_t ntpIntervalS_     = 0;  // current poll interval
+  uint32_t ntpNextMs_        = 0;  // millis() of the next scheduled sync
+  uint8_t  ntpFailures_      = 0;  // consecutive failures (backoff exponent)
+  SntpClient sntp_;                // built-in client (used with ntpServers/ntpTransport)
 };
 
 }
\ No newline at end of file
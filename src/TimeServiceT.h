@@ -0,0 +1,135 @@
+#pragma once
+#include <cstdint>
+#include "IDateTimeProvider.h"
+
+namespace sunlix {
+
+namespace detail {
+
+  /// Compile-time list of concrete provider pointers; dispatch by index without vtables.
+  template <class... Ps>
+  struct ProviderChain {
+    static constexpr std::uint8_t size = 0;
+    bool beginFirst(std::uint8_t&, std::uint8_t) { return false; }
+    template <class F> bool visit(std::uint8_t, F&) { return false; }
+    template <class F> bool visit(std::uint8_t, F&) const { return false; }
+  };
+
+  template <class P, class... Rest>
+  struct ProviderChain<P, Rest...> {
+    static constexpr std::uint8_t size = 1 + sizeof...(Rest);
+
+    P*                      head = nullptr;
+    ProviderChain<Rest...>  tail;
+
+    // Begin providers in order; the first that succeeds becomes active (index in `idx`).
+    bool beginFirst(std::uint8_t& idx, std::uint8_t base) {
+      if (head && head->begin()) { idx = base; return true; }
+      return tail.beginFirst(idx, static_cast<std::uint8_t>(base + 1));
+    }
+
+    // Call f(provider) on the provider at index i (direct, inlinable call: providers are final).
+    template <class F> bool visit(std::uint8_t i, F& f) {
+      if (i == 0) return head ? f(*head) : false;
+      return tail.visit(static_cast<std::uint8_t>(i - 1), f);
+    }
+    template <class F> bool visit(std::uint8_t i, F& f) const {
+      if (i == 0) return head ? f(static_cast<const P&>(*head)) : false;
+      return tail.visit(static_cast<std::uint8_t>(i - 1), f);
+    }
+  };
+
+  template <std::uint8_t I, class Chain> struct ChainAt;
+  template <class Chain> struct ChainAt<0, Chain> {
+    static auto& get(Chain& c) { return c.head; }
+  };
+  template <std::uint8_t I, class Chain> struct ChainAt {
+    static auto& get(Chain& c) { return ChainAt<I - 1, decltype(c.tail)>::get(c.tail); }
+  };
+
+}
+
+/**
+ * @class TimeServiceT
+ * @brief Compile-time provider selection: the facade without virtual dispatch.
+ *
+ * Design:
+ *  - Providers are listed by type in priority order, e.g.
+ *      TimeServiceT<RtcDateTimeProvider, UptimeDateTimeProvider>
+ *    and passed as pointers (nullptr = not present in this build/boot).
+ *  - begin() begins them in order; the first that succeeds becomes active.
+ *  - nowUtc()/nowUnixMs()/nowUnixUs()/adjust()/status() call the active provider's
+ *    concrete (final) member directly; with a single provider the hot path is straight-line.
+ *  - Only the listed provider types are referenced, so unused providers cost no flash/RAM.
+ *  - Owns nothing: provider storage belongs to the caller (static, member, ...).
+ */
+template <class... Providers>
+class TimeServiceT {
+public:
+  static constexpr std::uint8_t kNone = 0xFF;
+
+  explicit TimeServiceT(Providers*... providers) { assign_(chain_, providers...); }
+
+  /// Begin providers in priority order; returns true if one became active.
+  bool begin() {
+    active_ = kNone;
+    std::uint8_t idx = kNone;
+    if (chain_.beginFirst(idx, 0)) active_ = idx;
+    return active_ != kNone;
+  }
+
+  bool nowUtc(DateTime& out) {
+    auto f = [&](auto& p) { return p.nowUtc(out); };
+    return chain_.visit(active_, f);
+  }
+
+  bool nowUnixMs(std::uint64_t& out) {
+    auto f = [&](auto& p) { return p.nowUnixMs(out); };
+    return chain_.visit(active_, f);
+  }
+
+  bool nowUnixUs(std::uint64_t& out) {
+    auto f = [&](auto& p) { return p.nowUnixUs(out); };
+    return chain_.visit(active_, f);
+  }
+
+  bool adjust(const DateTime& t) {
+    auto f = [&](auto& p) { return p.adjust(t); };
+    return chain_.visit(active_, f);
+  }
+
+  TimeStatus status() const {
+    TimeStatus st = TimeStatus::NotStarted;
+    auto f = [&](const auto& p) { st = p.status(); return true; };
+    (void)chain_.visit(active_, f);
+    return st;
+  }
+
+  /// Index of the active provider in the type list, or kNone.
+  std::uint8_t activeIndex() const { return active_; }
+
+  /// Force the active provider (no begin() is called); returns false if out of range.
+  bool setActive(std::uint8_t idx) {
+    if (idx != kNone && idx >= Chain::size) return false;
+    active_ = idx;
+    return true;
+  }
+
+  /// Provider pointer slot at compile-time index I (e.g. to install a lazily built provider).
+  template <std::uint8_t I> auto& provider() { return detail::ChainAt<I, Chain>::get(chain_); }
+
+  /// Call f(activeProvider) with its concrete type; returns f's result or false if none.
+  template <class F> bool visitActive(F&& f) { return chain_.visit(active_, f); }
+
+private:
+  using Chain = detail::ProviderChain<Providers...>;
+
+  static void assign_(detail::ProviderChain<>&) {}
+  template <class C, class P, class... Rest>
+  static void assign_(C& c, P* p, Rest*... rest) { c.head = p; assign_(c.tail, rest...); }
+
+  Chain        chain_;
+  std::uint8_t active_ = kNone;
+};
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+#if !defined(SUNLIX_TIME_HOST)
+#include <Arduino.h>
+#include <Udp.h>
+#include "INtpTransport.h"
+
+namespace sunlix {
+
+/**
+ * @class UdpNtpTransport
+ * @brief INtpTransport over any Arduino UDP implementation (WiFiUDP, EthernetUDP, ...).
+ *
+ * Notes:
+ *  - Connectivity (Wi-Fi join, DHCP) stays the application's job.
+ *  - host must outlive the transport (typically a string literal).
+ *  - The server address is resolved once, in the first open() that succeeds, and cached;
+ *    send() always uses beginPacket(IPAddress, port), so no exchange does a DNS lookup.
+ *    A dotted-quad host (or the IPAddress constructor) needs no resolver. A hostname needs
+ *    setResolver(): the network library's lookup, which must honour timeoutMs. That one
+ *    open() blocks for up to timeoutMs; without a resolver it fails instead of letting
+ *    beginPacket(host) block on DNS at every send.
+ */
+class UdpNtpTransport final : public INtpTransport {
+public:
+  /// Network-library DNS lookup (e.g. WiFi.hostByName(), DNSClient::getHostByName()).
+  using Resolver = bool (*)(const char* host, IPAddress& out, uint16_t timeoutMs);
+
+  UdpNtpTransport(UDP& udp, const char* host, uint16_t localPort = 2390, uint16_t port = 123)
+  : udp_(udp), host_(host), localPort_(localPort), port_(port) {}
+
+  UdpNtpTransport(UDP& udp, const IPAddress& ip, uint16_t localPort = 2390, uint16_t port = 123)
+  : udp_(udp), host_(nullptr), localPort_(localPort), port_(port), ip_(ip), resolved_(true) {}
+
+  /// Resolve a hostname through `fn` (bounded by timeoutMs) on the next open().
+  void setResolver(Resolver fn, uint16_t timeoutMs = 2000) { resolve_ = fn; dnsTimeoutMs_ = timeoutMs; }
+
+  /// Drop the cached address; the next open() resolves again.
+  void forgetAddress() { if (host_) resolved_ = false; }
+
+  bool open() override {
+    if (!resolved_) {
+      if (ip_.fromString(host_))                              resolved_ = true;
+      else if (resolve_ && resolve_(host_, ip_, dnsTimeoutMs_)) resolved_ = true;
+      else return false;
+    }
+    if (open_) return true;
+    open_ = udp_.begin(localPort_) != 0;
+    return open_;
+  }
+
+  bool send(const std::uint8_t* data, std::uint8_t len) override {
+    if (!resolved_) return false;
+    // Drop any late reply from a previous exchange before sending
+    while (udp_.parsePacket() > 0) {}
+    if (udp_.beginPacket(ip_, port_) == 0) return false;
+    if (udp_.write(data, len) != len) { udp_.endPacket(); return false; }
+    return udp_.endPacket() != 0;
+  }
+
+  int receive(std::uint8_t* data, std::uint8_t cap) override {
+    const int sz = udp_.parsePacket();
+    if (sz <= 0) return 0;
+    return udp_.read(data, cap);
+  }
+
+  void close() override {
+    if (open_) udp_.stop();
+    open_ = false;
+  }
+
+private:
+  UDP&        udp_;
+  const char* host_;
+  uint16_t    localPort_;
+  uint16_t    port_;
+  IPAddress   ip_;
+  bool        resolved_ = false;
+  Resolver    resolve_  = nullptr;
+  uint16_t    dnsTimeoutMs_ = 2000;
+  bool        open_ = false;
+};
+
+}
+#endif
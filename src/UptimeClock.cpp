@@ -0,0 +1,34 @@
+#include "TimeHal.h"
+#include "UptimeClock.h"
+
+namespace sunlix {
+namespace uptime {
+
+namespace {
+  std::uint32_t s_msLast = 0;  // last raw millis()
+  std::uint32_t s_msHigh = 0;  // number of millis() wraps seen
+  std::uint32_t s_usLast = 0;  // last raw micros()
+  std::uint32_t s_usHigh = 0;  // number of micros() wraps seen
+}
+
+std::uint64_t millis64() {
+  const std::uint32_t now = millis();
+  if (now < s_msLast) ++s_msHigh;  // wrapped since last sample
+  s_msLast = now;
+  return (static_cast<std::uint64_t>(s_msHigh) << 32) | now;
+}
+
+std::uint64_t micros64() {
+  const std::uint32_t now = micros();
+  if (now < s_usLast) ++s_usHigh;  // wrapped since last sample
+  s_usLast = now;
+  return (static_cast<std::uint64_t>(s_usHigh) << 32) | now;
+}
+
+void poll() {
+  (void)millis64();
+  (void)micros64();
+}
+
+}
+}
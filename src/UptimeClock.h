@@ -0,0 +1,31 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * @file UptimeClock.h
+ * @brief 64-bit extensions of Arduino millis()/micros() that survive their 32-bit wrap.
+ *
+ * Notes:
+ *  - Each call compares the raw counter with the last seen value and carries into
+ *    a high word on wrap; cost is one compare + one add.
+ *  - A wrap is only detected if the counter is sampled at least once per period:
+ *      millis(): every < 49.7 days, micros(): every < 71.6 minutes.
+ *    Call uptime::poll() from loop() (or any periodic task) to guarantee this.
+ *  - Main-context API: do not call from ISRs. The state is never touched by an ISR,
+ *    so no interrupt masking is needed.
+ */
+
+namespace sunlix {
+namespace uptime {
+
+  /// Milliseconds since boot, 64-bit (never wraps in practice).
+  std::uint64_t millis64();
+
+  /// Microseconds since boot, 64-bit (never wraps in practice).
+  std::uint64_t micros64();
+
+  /// Periodic hook: samples both counters so no wrap can be missed.
+  void poll();
+
+}
+}
@@ -1,94 +1,116 @@
-#include <Arduino.h>
+#include "TimeHal.h"
 #include "UptimeDateTimeProvider.h"
+#include "CivilTime.h"
+#include "UptimeClock.h"
 
 namespace sunlix {
 
+// 2000-01-01 00:00:00.000 UTC in UNIX milliseconds
+static constexpr std::uint64_t kDefaultBaseUnixMs = 946684800000ULL;
+
+// Learning: ignore trusted pairs closer than this (ms quantization dominates)
+static constexpr std::uint64_t kMinLearnMs  = 60000ULL;
+static constexpr std::int32_t  kMaxCorrPpb  = 10000000;   // ±1 %
+
 UptimeDateTimeProvider::UptimeDateTimeProvider() = default;
 
 bool UptimeDateTimeProvider::begin() {
   // Default base: 2000-01-01 00:00:00.000
-  base_.year = 2000; base_.month = 1; base_.day = 1;
-  base_.hour = 0;    base_.minute = 0; base_.second = 0;
-  base_.millis = 0;
+  baseUnixMs_ = kDefaultBaseUnixMs;
+  cache_.invalidate();
 
-  t0_ms_   = millis();
+  t0_ms_   = uptime::millis64();
   started_ = true;
   status_  = TimeStatus::Ok;
   return true;
 }
 
-bool UptimeDateTimeProvider::nowUtc(DateTime& out) {
+bool UptimeDateTimeProvider::nowUnixMs(std::uint64_t& out) {
   if (!started_) {
     status_ = TimeStatus::NotStarted;
     return false;
   }
 
-  const std::uint32_t now_ms  = millis();
-  const std::uint32_t elapsed = now_ms - t0_ms_;   // wrap-safe
-  const std::uint32_t add_s   = elapsed / 1000U;
-  const std::uint16_t ms      = static_cast<std::uint16_t>(elapsed % 1000U);
-
-  out = addSeconds(base_, add_s);
-  out.millis = ms;
+  out = baseUnixMs_ + elapsedMs_(uptime::millis64());   // 64-bit: no 49.7-day wrap
   return true;
 }
 
-bool UptimeDateTimeProvider::adjust(const DateTime& t) {
-  if (!started_) begin();
-
-  // Clamp millis to [0..999]; ignore mode for uptime (we always anchor to provided ms)
-  std::uint16_t m = (t.millis <= 999) ? t.millis : 0;
+std::uint64_t UptimeDateTimeProvider::elapsedMs_(std::uint64_t nowMs) const {
+  const std::uint64_t el = nowMs - t0_ms_;
+  if (corrQ32_ == 0) return el;
+  // el·corrQ32_ >> 32 in two halves of el: |corrQ32_| < 2^26 keeps each product in range
+  // for any el (a single product overflowed past ~2^37 ms, 4 years without an adjust())
+  const std::int64_t hi = static_cast<std::int64_t>(el >> 32) * corrQ32_;
+  const std::int64_t lo = (static_cast<std::int64_t>(el & 0xFFFFFFFFULL) * corrQ32_) >> 32;
+  return el + static_cast<std::uint64_t>(hi + lo);
+}
 
-  base_ = t;
-  base_.millis = 0;
+void UptimeDateTimeProvider::rebase_() {
+  const std::uint64_t now = uptime::millis64();
+  baseUnixMs_ += elapsedMs_(now);
+  t0_ms_ = now;
+}
 
-  t0_ms_ = millis();
-  status_ = TimeStatus::Ok;
+bool UptimeDateTimeProvider::nowUnixUs(std::uint64_t& out) {
+  std::uint64_t ms = 0;
+  if (!nowUnixMs(ms)) return false;
+  out = ms * 1000U;                        // millis()-based: millisecond resolution
   return true;
 }
 
-TimeStatus UptimeDateTimeProvider::status() const { return status_; }
-
-// --------- helpers ---------
+bool UptimeDateTimeProvider::nowUtc(DateTime& out) {
+  std::uint64_t ms = 0;
+  if (!nowUnixMs(ms)) return false;
 
-bool UptimeDateTimeProvider::isLeap(std::uint16_t y) {
-  return ((y % 4 == 0) && (y % 100 != 0)) || (y % 400 == 0);
+  // Field decomposition only happens here, at most once per second
+  cache_.getMs(ms, out);
+  return true;
 }
 
-std::uint8_t UptimeDateTimeProvider::daysInMonth(std::uint16_t y, std::uint8_t m) {
-  static const std::uint8_t dm[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
-  if (m == 2) return dm[1] + (isLeap(y) ? 1 : 0);
-  return dm[m - 1];
+bool UptimeDateTimeProvider::adjust(const DateTime& t) {
+  if (!started_) begin();
+
+  // Anchor to the provided subsecond phase; out-of-range millis treated as 0
+  baseUnixMs_ = civil::toUnixMs(t);
+  cache_.invalidate();
+
+  t0_ms_ = uptime::millis64();
+  status_ = TimeStatus::Ok;
+  return true;
 }
 
-DateTime UptimeDateTimeProvider::addSeconds(const DateTime& in, std::uint32_t add_s) {
-  DateTime out = in;
-
-  // time-of-day rollover
-  std::uint32_t sod = static_cast<std::uint32_t>(in.hour) * 3600U
-                    + static_cast<std::uint32_t>(in.minute) * 60U
-                    + static_cast<std::uint32_t>(in.second);
-  std::uint32_t total = sod + add_s;
-
-  out.hour   = static_cast<std::uint8_t>((total / 3600U) % 24U);
-  out.minute = static_cast<std::uint8_t>((total / 60U) % 60U);
-  out.second = static_cast<std::uint8_t>( total % 60U );
-
-  // day rollover
-  std::uint32_t daysAdd = total / 86400U;
-  while (daysAdd--) {
-    std::uint8_t dim = daysInMonth(out.year, out.month);
-    if (out.day < dim) {
-      ++out.day;
-    } else {
-      out.day = 1;
-      if (out.month < 12) ++out.month;
-      else { out.month = 1; ++out.year; }
+bool UptimeDateTimeProvider::adjustTrusted(const DateTime& t) {
+  const std::uint64_t refMs = civil::toUnixMs(t);
+  const std::uint64_t rawMs = uptime::millis64();
+
+  if (hasTrusted_ && rawMs - trustedRawMs_ >= kMinLearnMs && refMs > trustedUnixMs_) {
+    // Rate error over the interval, from raw (uncorrected) millis: independent of corrPpb_
+    std::int64_t rawEl = static_cast<std::int64_t>(rawMs - trustedRawMs_);
+    std::int64_t diff  = static_cast<std::int64_t>(refMs - trustedUnixMs_) - rawEl;
+    const std::int64_t maxDiff = rawEl / (1000000000LL / kMaxCorrPpb);
+    if (diff >= -maxDiff && diff <= maxDiff) {                // else: a step, not drift
+      // |diff| ≤ rawEl/100; scale both below 2^33 so diff·1e9 stays inside int64
+      while (rawEl >= (1LL << 33)) { rawEl >>= 1; diff /= 2; }
+      const std::int64_t ppb     = diff * 1000000000LL / rawEl;
+      const std::int64_t blended = (corrPpb_ == 0) ? ppb : corrPpb_ + (ppb - corrPpb_) / 2;
+      setCorrectionPpb(static_cast<std::int32_t>(blended));
     }
   }
 
-  // millis is set by caller
-  return out;
+  hasTrusted_    = true;
+  trustedUnixMs_ = refMs;
+  trustedRawMs_  = rawMs;
+  return adjust(t);
+}
+
+void UptimeDateTimeProvider::setCorrectionPpb(std::int32_t ppb) {
+  if (ppb >  kMaxCorrPpb) ppb =  kMaxCorrPpb;
+  if (ppb < -kMaxCorrPpb) ppb = -kMaxCorrPpb;
+  if (started_) rebase_();   // rate change applies from now on; no jump
+  corrPpb_ = ppb;
+  corrQ32_ = (static_cast<std::int64_t>(ppb) << 32) / 1000000000LL;
 }
 
+TimeStatus UptimeDateTimeProvider::status() const { return status_; }
+
 }
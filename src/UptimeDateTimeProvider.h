@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include "IDateTimeProvider.h"
+#include "CalendarCache.h"
 
 namespace sunlix {
 
@@ -9,8 +10,20 @@ namespace sunlix {
  * @brief Time provider based on MCU uptime (millis) with a configurable base.
  *
  * - begin(): sets base to 2000-01-01 00:00:00.000
- * - adjust(): sets a new base and re-anchors milliseconds
- * - nowUtc(): base + (millis() - anchor), with millis in [0..999]
+ * - adjust(): sets a new base (UNIX ms, including t.millis) and re-anchors milliseconds
+ * - nowUnixMs(): base + (millis64() - anchor); no calendar math
+ * - nowUtc(): nowUnixMs() decomposed into fields, with millis in [0..999];
+ *             fields are cached per second (CalendarCache), invalidated by begin()/adjust()
+ *
+ * Elapsed time uses the 64-bit uptime::millis64() counter, so the base stays valid
+ * across millis() wraps as long as the clock is sampled at least every 49.7 days
+ * (any nowUtc() call or uptime::poll() does this).
+ *
+ * Drift correction:
+ *  - elapsed is scaled by (1 + correctionPpb·1e-9), applied as a Q32 multiply (no floats).
+ *  - adjustTrusted(): adjust() from a reference (NTP); two of them ≥ 60 s apart measure the
+ *    oscillator's rate error, which is blended into the correction (first one taken as is).
+ *  - setCorrectionPpb(): preload a known correction (e.g. stored from a previous run).
  */
 class UptimeDateTimeProvider final : public IDateTimeProvider {
 public:
@@ -18,20 +31,33 @@ public:
 
   bool begin() override;
   bool nowUtc(DateTime& out) override;
+  bool nowUnixMs(std::uint64_t& out) override;
+  bool nowUnixUs(std::uint64_t& out) override;
   bool adjust(const DateTime& t) override;
   TimeStatus status() const override;
 
-private:
-  static bool         isLeap(std::uint16_t y);
-  static std::uint8_t daysInMonth(std::uint16_t y, std::uint8_t m);
-  static DateTime     addSeconds(const DateTime& in, std::uint32_t add_s);
+  /// adjust() from a trusted reference; also learns the oscillator's rate error.
+  bool adjustTrusted(const DateTime& t);
+
+  /// Preload/override the rate correction (ppb, + = millis() runs slow); clamped to ±1 %.
+  void setCorrectionPpb(std::int32_t ppb);
+  std::int32_t correctionPpb() const { return corrPpb_; }
 
 private:
+  std::uint64_t elapsedMs_(std::uint64_t nowMs) const;  // corrected ms since t0_ms_
+  void rebase_();                                       // fold elapsed into the base at now
   bool       started_ = false;
   TimeStatus status_  = TimeStatus::NotStarted;
 
-  DateTime   base_{};   // anchored date-time, millis field kept at 0
-  std::uint32_t t0_ms_ = 0; // millis() at the base anchor
+  std::uint64_t baseUnixMs_ = 0; // UNIX ms at the base anchor
+  CalendarCache cache_;          // fields of the current second
+  std::uint64_t t0_ms_ = 0; // uptime::millis64() at the base anchor
+
+  std::int32_t  corrPpb_ = 0;     // rate correction
+  std::int64_t  corrQ32_ = 0;     // same as a Q32 fraction: corrPpb_·2^32/1e9
+  bool          hasTrusted_ = false;
+  std::uint64_t trustedUnixMs_ = 0; // last trusted time ...
+  std::uint64_t trustedRawMs_  = 0; // ... at this uncorrected millis64()
 };
 
 }
@@ -0,0 +1,38 @@
+#if defined(SUNLIX_TIME_HOST)
+#include "FileNvStore.h"
+#include <cstdio>
+
+namespace sunlix {
+namespace hostsim {
+
+bool FileNvStore::read(uint16_t addr, uint8_t* buf, uint16_t len) {
+  if (static_cast<uint32_t>(addr) + len > size_) return false;
+  for (uint16_t i = 0; i < len; ++i) buf[i] = 0xFF;
+
+  FILE* f = std::fopen(path_, "rb");
+  if (!f) return true;                       // never written: erased
+  if (std::fseek(f, addr, SEEK_SET) == 0) (void)std::fread(buf, 1, len, f);
+  std::fclose(f);
+  return true;
+}
+
+bool FileNvStore::write(uint16_t addr, const uint8_t* buf, uint16_t len) {
+  if (static_cast<uint32_t>(addr) + len > size_) return false;
+
+  // Read-modify-write the whole image (size_ is small), counting changed bytes
+  static uint8_t img[65535];
+  (void)read(0, img, size_);
+  for (uint16_t i = 0; i < len; ++i) {
+    if (img[addr + i] != buf[i]) { img[addr + i] = buf[i]; ++writes_; }
+  }
+
+  FILE* f = std::fopen(path_, "wb");
+  if (!f) return false;
+  const bool ok = std::fwrite(img, 1, size_, f) == size_;
+  std::fclose(f);
+  return ok;
+}
+
+}
+}
+#endif
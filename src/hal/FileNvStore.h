@@ -0,0 +1,34 @@
+#pragma once
+#if defined(SUNLIX_TIME_HOST)
+#include <cstdint>
+#include "../INvStore.h"
+
+namespace sunlix {
+namespace hostsim {
+
+/**
+ * @class FileNvStore
+ * @brief Host INvStore backed by a file (survives simulated reboots = process restarts).
+ *
+ * The file is created on first write and grows to size(); unwritten bytes read as 0xFF
+ * (erased EEPROM). writeCount() counts bytes actually changed, for wear checks.
+ */
+class FileNvStore final : public INvStore {
+public:
+  FileNvStore(const char* path, uint16_t size) : path_(path), size_(size) {}
+
+  uint16_t size() const override { return size_; }
+  bool read(uint16_t addr, uint8_t* buf, uint16_t len) override;
+  bool write(uint16_t addr, const uint8_t* buf, uint16_t len) override;
+
+  uint32_t writeCount() const { return writes_; }
+
+private:
+  const char* path_;
+  uint16_t    size_;
+  uint32_t    writes_ = 0;
+};
+
+}
+}
+#endif
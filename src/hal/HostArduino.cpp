@@ -0,0 +1,225 @@
+#if defined(SUNLIX_TIME_HOST)
+#include "HostArduino.h"
+#include "../CivilTime.h"
+
+// ---------------- simulation state ----------------
+
+namespace {
+  constexpr int kMaxPins = 64;
+
+  uint64_t g_nowUs    = 0;       // virtual MCU time
+  bool     g_irqOff   = false;   // inside noInterrupts()
+  bool     g_delivery = true;    // ISR delivery enabled
+  uint32_t g_isrCount = 0;
+  uint32_t g_lcg      = 12345U;  // jitter PRNG
+
+  void (*g_isr[kMaxPins])()   = {};
+  bool   g_pending[kMaxPins]  = {};
+  uint64_t g_edgeUs[kMaxPins] = {};   // exact time of the last SQW edge (input-capture latch)
+
+  uint32_t nextRand() {
+    g_lcg = g_lcg * 1664525U + 1013904223U;
+    return g_lcg >> 8;
+  }
+
+  void deliver(uint8_t pin) {
+    if (pin >= kMaxPins || !g_isr[pin] || !g_delivery) return;
+    if (g_irqOff) { g_pending[pin] = true; return; }   // latched until interrupts()
+    ++g_isrCount;
+    g_isr[pin]();
+  }
+}
+
+struct HostRegistry_ {
+  static RTC_DS3231*& head() { static RTC_DS3231* h = nullptr; return h; }
+
+  // Earliest pending tick across all chips, or nullptr.
+  static RTC_DS3231* earliest(uint64_t limitNs) {
+    RTC_DS3231* best = nullptr;
+    for (RTC_DS3231* c = head(); c; c = c->next_) {
+      const uint64_t t = c->nextTickNs_();
+      if (t <= limitNs && (!best || t < best->nextTickNs_())) best = c;
+    }
+    return best;
+  }
+
+  static bool anyResponding() {
+    for (RTC_DS3231* c = head(); c; c = c->next_) {
+      if (c->responding_) return true;
+    }
+    return false;
+  }
+
+  static void restart(uint64_t startUs) {
+    for (RTC_DS3231* c = head(); c; c = c->next_) {
+      c->secStartNs_ = startUs * 1000ULL;
+      c->edgeInSec_  = 1;
+    }
+  }
+
+  static void runUntil(uint64_t targetUs) {
+    const uint64_t limitNs = targetUs * 1000ULL;
+    while (RTC_DS3231* c = earliest(limitNs)) {
+      const uint64_t tUs = c->nextTickNs_() / 1000ULL;
+      if (tUs > g_nowUs) g_nowUs = tUs;
+      c->tick_();
+    }
+    if (targetUs > g_nowUs) g_nowUs = targetUs;
+  }
+};
+
+// ---------------- Arduino core subset ----------------
+
+uint32_t millis() { return static_cast<uint32_t>(g_nowUs / 1000ULL); }
+uint32_t micros() { return static_cast<uint32_t>(g_nowUs); }
+void     delay(uint32_t ms) { sunlix::hostsim::advanceUs(static_cast<uint64_t>(ms) * 1000ULL); }
+void     delayMicroseconds(uint32_t us) { sunlix::hostsim::advanceUs(us); }
+
+void noInterrupts() { g_irqOff = true; }
+void interrupts() {
+  g_irqOff = false;
+  for (int p = 0; p < kMaxPins; ++p) {
+    if (g_pending[p]) { g_pending[p] = false; deliver(static_cast<uint8_t>(p)); }
+  }
+}
+
+void pinMode(uint8_t, uint8_t) {}
+int  digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+void attachInterrupt(int irq, void (*isr)(), PinStatus) {
+  if (irq >= 0 && irq < kMaxPins) g_isr[irq] = isr;
+}
+
+void detachInterrupt(int irq) {
+  if (irq >= 0 && irq < kMaxPins) { g_isr[irq] = nullptr; g_pending[irq] = false; }
+}
+
+// ---------------- Wire subset ----------------
+
+TwoWire Wire;
+
+uint8_t TwoWire::endTransmission(bool) {
+  ++transmissions_;
+  return (addr_ == 0x68 && HostRegistry_::anyResponding()) ? 0 : 2;
+}
+
+// ---------------- RTClib subset ----------------
+
+DateTime::DateTime(uint32_t unixSec) : unix_(unixSec) {
+  sunlix::DateTime f{};
+  sunlix::civil::fromUnix(unixSec, f);
+  y_ = f.year; m_ = f.month; d_ = f.day; hh_ = f.hour; mm_ = f.minute; ss_ = f.second;
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second)
+: y_(year), m_(month), d_(day), hh_(hour), mm_(minute), ss_(second) {
+  const sunlix::DateTime f{year, month, day, hour, minute, second, 0};
+  unix_ = sunlix::civil::toUnix(f);
+}
+
+RTC_DS3231::RTC_DS3231() {
+  secStartNs_ = g_nowUs * 1000ULL;
+  next_ = HostRegistry_::head();
+  HostRegistry_::head() = this;
+}
+
+RTC_DS3231::~RTC_DS3231() {
+  for (RTC_DS3231** pp = &HostRegistry_::head(); *pp; pp = &(*pp)->next_) {
+    if (*pp == this) { *pp = next_; break; }
+  }
+}
+
+bool     RTC_DS3231::begin()     { ++beginCalls_; return responding_; }
+bool     RTC_DS3231::lostPower() { return responding_ && lostPower_; }
+
+DateTime RTC_DS3231::now() {
+  // Time registers latch at the START of the read; the transfer itself takes kReadUs
+  const DateTime t(responding_ ? unix_ : 0U);     // bus error reads as garbage
+  sunlix::hostsim::advanceUs(kReadUs);
+  return t;
+}
+
+void RTC_DS3231::adjust(const DateTime& dt) {
+  if (!responding_) return;
+  // Writing the seconds register restarts the DS3231 countdown chain.
+  unix_       = dt.unixtime();
+  secStartNs_ = g_nowUs * 1000ULL;
+  edgeInSec_  = 1;
+  lostPower_  = false;
+}
+
+void RTC_DS3231::writeSqwPinMode(Ds3231SqwPinMode mode) {
+  if (!responding_) return;
+  switch (mode) {
+    case DS3231_SquareWave1Hz:  sqwHz_ = 1;    break;
+    case DS3231_SquareWave1kHz: sqwHz_ = 1024; break;
+    case DS3231_SquareWave4kHz: sqwHz_ = 4096; break;
+    case DS3231_SquareWave8kHz: sqwHz_ = 8192; break;
+    default:                    sqwHz_ = 0;    break;
+  }
+  resyncTicks_();
+}
+
+void RTC_DS3231::setDriftPpb(int32_t ppb) { driftPpb_ = ppb; }
+
+uint64_t RTC_DS3231::secondLenNs_() const {
+  // RTC fast by +ppb => its second is that many ns shorter in MCU time
+  return static_cast<uint64_t>(static_cast<int64_t>(1000000000LL) - driftPpb_);
+}
+
+uint64_t RTC_DS3231::nextTickNs_() const {
+  return secStartNs_ + secondLenNs_() * edgeInSec_ / tickHz_();
+}
+
+void RTC_DS3231::resyncTicks_() {
+  const uint64_t nowNs = g_nowUs * 1000ULL;
+  const uint64_t inSec = (nowNs > secStartNs_) ? nowNs - secStartNs_ : 0;
+  edgeInSec_ = static_cast<uint32_t>(inSec * tickHz_() / secondLenNs_()) + 1U;
+}
+
+void RTC_DS3231::tick_() {
+  const bool boundary = (edgeInSec_ >= tickHz_());
+  if (boundary) {
+    ++unix_;
+    secStartNs_ += secondLenNs_();
+    edgeInSec_   = 1;
+  } else {
+    ++edgeInSec_;
+  }
+
+  if (!sqwHz_ || !sqwRunning_) return;
+  ++edges_;
+
+  // ISR entry latency jitter: the handler observes a slightly later micros()
+  const uint64_t edgeUs = g_nowUs;
+  if (sqwPin_ < kMaxPins) g_edgeUs[sqwPin_] = edgeUs;
+  if (jitterUs_) g_nowUs = edgeUs + nextRand() % (jitterUs_ + 1U);
+  deliver(sqwPin_);
+  if (g_nowUs < edgeUs) g_nowUs = edgeUs;
+}
+
+// ---------------- Simulation control ----------------
+
+namespace sunlix {
+namespace hostsim {
+
+void reset(uint64_t startUs) {
+  g_nowUs    = startUs;
+  g_irqOff   = false;
+  g_delivery = true;
+  g_isrCount = 0;
+  g_lcg      = 12345U;
+  for (int p = 0; p < kMaxPins; ++p) { g_isr[p] = nullptr; g_pending[p] = false; g_edgeUs[p] = 0; }
+  HostRegistry_::restart(startUs);
+}
+
+uint64_t nowUs()                 { return g_nowUs; }
+void     advanceUs(uint64_t us)  { HostRegistry_::runUntil(g_nowUs + us); }
+void     setIsrDelivery(bool on) { g_delivery = on; }
+uint32_t isrCount()              { return g_isrCount; }
+uint64_t lastEdgeUs(uint8_t pin) { return pin < kMaxPins ? g_edgeUs[pin] : 0; }
+
+}
+}
+
+#endif
@@ -0,0 +1,169 @@
+#pragma once
+#if defined(SUNLIX_TIME_HOST)
+#include <stdint.h>
+#include <cstdint>
+
+/**
+ * @file HostArduino.h
+ * @brief Host (Linux) stand-ins for the Arduino core and RTClib used by this library.
+ *
+ * Design:
+ *  - Virtual clock: millis()/micros() read a 64-bit simulated microsecond counter that only
+ *    moves through hostsim::advanceUs() (or delay(), which advances it).
+ *  - Simulated DS3231 (RTC_DS3231): seconds counter, SQW output at 1 Hz or 1.024/4.096/8.192 kHz,
+ *    configurable drift (ppb vs. the MCU clock) and per-edge ISR jitter, lost-power flag,
+ *    and an I2C "responding" switch. now() latches the time at its start and then advances
+ *    virtual time by kReadUs, like a real register read. Wire only answers address probes (0x68 ACKs while a
+ *    simulated chip responds).
+ *  - ISR delivery: SQW edges call the routine registered with attachInterrupt() for the
+ *    DS3231's pin. While noInterrupts() is active, one edge per pin is latched (as on real
+ *    MCUs) and delivered by interrupts(); setIsrDelivery(false) drops edges entirely.
+ *  - Input capture: the exact time of each SQW edge (before ISR latency) is latched per pin,
+ *    see lastEdgeUs() and hal/SimSqwCapture.h.
+ *  - Deterministic: no wall clock, no threads; jitter comes from a seeded LCG.
+ *
+ * Only the API surface the library uses is provided.
+ */
+
+// ---------------- Arduino core subset ----------------
+
+enum PinStatus { LOW = 0, HIGH = 1, CHANGE = 2, FALLING = 3, RISING = 4 };
+
+constexpr uint8_t INPUT        = 0;
+constexpr uint8_t OUTPUT       = 1;
+constexpr uint8_t INPUT_PULLUP = 2;
+
+uint32_t millis();
+uint32_t micros();
+void     delay(uint32_t ms);
+void     delayMicroseconds(uint32_t us);
+void     noInterrupts();
+void     interrupts();
+void     pinMode(uint8_t pin, uint8_t mode);
+int      digitalPinToInterrupt(uint8_t pin);
+void     attachInterrupt(int irq, void (*isr)(), PinStatus mode);
+void     detachInterrupt(int irq);
+
+// ---------------- Wire subset ----------------
+
+/// I2C bus: address probes only (the simulated DS3231 is reached through RTC_DS3231).
+class TwoWire {
+public:
+  void    begin() {}
+  void    beginTransmission(uint8_t address) { addr_ = address; }
+  uint8_t endTransmission(bool sendStop = true);   ///< 0 = ACK, 2 = address NACK
+  uint32_t transmissions() const { return transmissions_; }
+private:
+  uint8_t  addr_          = 0;
+  uint32_t transmissions_ = 0;
+};
+
+extern TwoWire Wire;
+
+// ---------------- RTClib subset ----------------
+
+enum Ds3231SqwPinMode {
+  DS3231_OFF,
+  DS3231_SquareWave1Hz,
+  DS3231_SquareWave1kHz,
+  DS3231_SquareWave4kHz,
+  DS3231_SquareWave8kHz
+};
+
+/// RTClib-compatible calendar value (UTC seconds since 1970).
+class DateTime {
+public:
+  DateTime(uint32_t unixSec = 946684800UL);
+  DateTime(uint16_t year, uint8_t month, uint8_t day,
+           uint8_t hour = 0, uint8_t minute = 0, uint8_t second = 0);
+
+  uint16_t year()   const { return y_; }
+  uint8_t  month()  const { return m_; }
+  uint8_t  day()    const { return d_; }
+  uint8_t  hour()   const { return hh_; }
+  uint8_t  minute() const { return mm_; }
+  uint8_t  second() const { return ss_; }
+  uint32_t unixtime() const { return unix_; }
+
+private:
+  uint32_t unix_;
+  uint16_t y_;
+  uint8_t  m_, d_, hh_, mm_, ss_;
+};
+
+/// Simulated DS3231. One instance per simulated chip; wire its SQW with setSqwPin().
+class RTC_DS3231 {
+public:
+  RTC_DS3231();
+  ~RTC_DS3231();
+
+  // RTClib API
+  bool     begin();
+  DateTime now();
+  void     adjust(const DateTime& dt);
+  bool     lostPower();
+  void     writeSqwPinMode(Ds3231SqwPinMode mode);
+
+  // --- simulation controls ---
+  void setSqwPin(uint8_t pin)          { sqwPin_ = pin; }
+  void setDriftPpb(int32_t ppb);                          ///< + = RTC runs fast vs. MCU clock
+  void setJitterUs(uint32_t us)        { jitterUs_ = us; } ///< max extra ISR latency per edge
+  void setLostPower(bool lost)         { lostPower_ = lost; }
+  void setResponding(bool on)          { responding_ = on; } ///< I2C ACK on/off
+  void setSqwRunning(bool on)          { sqwRunning_ = on; } ///< false = wire cut, no edges
+  uint32_t edgesGenerated() const      { return edges_; }
+  uint32_t beginCalls() const          { return beginCalls_; }
+
+  static constexpr uint32_t kReadUs = 200;  ///< now(): 7 time registers at 400 kHz I2C
+
+private:
+  uint16_t tickHz_() const { return sqwHz_ ? sqwHz_ : 1; }
+  uint64_t secondLenNs_() const;
+  uint64_t nextTickNs_() const;
+  void     tick_();          // emit the next SQW edge / second boundary
+  void     resyncTicks_();   // recompute edge index after a rate change
+
+  uint32_t unix_        = 946684800UL; // current RTC second
+  uint64_t secStartNs_  = 0;           // MCU time (ns) at which unix_ began
+  uint32_t edgeInSec_   = 1;           // index (1..Hz) of the next edge within the second
+  int32_t  driftPpb_    = 0;
+  uint32_t jitterUs_    = 0;
+  uint32_t edges_       = 0;
+  uint32_t beginCalls_  = 0;
+  uint16_t sqwHz_       = 0;           // 0 = SQW off
+  uint8_t  sqwPin_      = 2;
+  bool     lostPower_   = false;
+  bool     responding_  = true;
+  bool     sqwRunning_  = true;
+
+  RTC_DS3231* next_     = nullptr;     // intrusive registry of live chips
+  friend struct HostRegistry_;
+};
+
+// ---------------- Simulation control ----------------
+
+namespace sunlix {
+namespace hostsim {
+
+  /// Reset virtual time to 0, clear ISRs and pending edges (chips keep their settings).
+  void reset(uint64_t startUs = 0);
+
+  /// Current virtual MCU time in microseconds (64-bit, never wraps).
+  uint64_t nowUs();
+
+  /// Advance virtual time, delivering SQW edges in order.
+  void advanceUs(uint64_t us);
+
+  /// Enable/disable ISR delivery globally (disabled = edges are lost, not latched).
+  void setIsrDelivery(bool on);
+
+  /// Number of ISR invocations delivered so far.
+  uint32_t isrCount();
+
+  /// Virtual time of the latest SQW edge on `pin`, without ISR latency (0 = none yet).
+  uint64_t lastEdgeUs(uint8_t pin);
+
+}
+}
+
+#endif
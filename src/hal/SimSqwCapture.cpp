@@ -0,0 +1,30 @@
+#if defined(SUNLIX_TIME_HOST)
+#include "SimSqwCapture.h"
+
+namespace sunlix {
+namespace hostsim {
+
+bool SimSqwCapture::begin(uint8_t pin, PinStatus edge, void (*onEdge)()) {
+  if (!onEdge || (edge != RISING && edge != FALLING)) return false;
+  if (armed_) end();
+  pin_   = pin;
+  armed_ = true;
+  attachInterrupt(digitalPinToInterrupt(pin), onEdge, edge);
+  return true;
+}
+
+void SimSqwCapture::end() {
+  if (!armed_) return;
+  detachInterrupt(digitalPinToInterrupt(pin_));
+  armed_ = false;
+}
+
+uint32_t SimSqwCapture::capturedUs() {
+  ++captures_;
+  const uint64_t t = lastEdgeUs(pin_);
+  return static_cast<uint32_t>(t - t % resUs_);
+}
+
+}
+}
+#endif
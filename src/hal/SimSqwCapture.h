@@ -0,0 +1,36 @@
+#pragma once
+#if defined(SUNLIX_TIME_HOST)
+#include <cstdint>
+#include "../ISqwCapture.h"
+
+namespace sunlix {
+namespace hostsim {
+
+/**
+ * @class SimSqwCapture
+ * @brief Host ISqwCapture: timestamps come from the simulated edge itself, not the ISR.
+ *
+ * The callback is delivered like an interrupt (same latency, jitter and masking as
+ * attachInterrupt()), but capturedUs() returns the exact edge time rounded down to
+ * resolutionUs, as a hardware capture register would (e.g. 4 for AVR micros()).
+ */
+class SimSqwCapture final : public ISqwCapture {
+public:
+  explicit SimSqwCapture(uint32_t resolutionUs = 1) : resUs_(resolutionUs ? resolutionUs : 1) {}
+
+  bool     begin(uint8_t pin, PinStatus edge, void (*onEdge)()) override;
+  void     end() override;
+  uint32_t capturedUs() override;
+
+  uint32_t captureCount() const { return captures_; }
+
+private:
+  uint32_t resUs_;
+  uint8_t  pin_      = 0;
+  bool     armed_    = false;
+  uint32_t captures_ = 0;
+};
+
+}
+}
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "TimeHal.h"
+#include "INtpTransport.h"
+
+namespace sunlix {
+namespace test {
+
+/**
+ * @class FakeNtpServer
+ * @brief In-process NTP server behind INtpTransport, timed by the host simulation.
+ *
+ * The reference is the simulated MCU clock itself: true UTC = utcAtZeroUs + hostsim::nowUs().
+ * A reply becomes receivable after the request and reply path delays (plus random jitter
+ * up to jitterUs each way, and on queuePercent % of the legs a queueing delay up to
+ * queueUs); its T2/T3 are the true time at the server, shifted by offsetUs
+ * for a falseticker. No heap, deterministic (seeded LCG).
+ */
+class FakeNtpServer final : public INtpTransport {
+public:
+  explicit FakeNtpServer(uint64_t utcAtZeroUs) : utcAtZeroUs_(utcAtZeroUs) {}
+
+  void setDelayUs(uint32_t upUs, uint32_t downUs) { upUs_ = upUs; downUs_ = downUs; }
+  void setJitterUs(uint32_t us)    { jitterUs_ = us; }
+  void setQueueUs(uint32_t maxUs, uint8_t percent) { queueUs_ = maxUs; queuePct_ = percent; }
+  void setOffsetUs(int64_t us)     { offsetUs_ = us; }   ///< falseticker: report true + us
+  void setResponding(bool on)      { responding_ = on; }
+  void setSeed(uint32_t seed)      { lcg_ = seed; }
+
+  uint64_t trueUtcUs() const       { return utcAtZeroUs_ + hostsim::nowUs(); }
+  uint32_t requests() const        { return requests_; }
+
+  bool open() override { return true; }
+  void close() override {}
+
+  bool send(const uint8_t* data, uint8_t len) override {
+    if (len < 48) return false;
+    ++requests_;
+    std::memcpy(token_, data + 40, 8);
+    const uint64_t now = hostsim::nowUs();
+    arriveUs_ = now + upUs_ + rand_() + queue_();
+    replyUs_  = arriveUs_ + kProcUs + downUs_ + rand_() + queue_();
+    pending_  = responding_;
+    return true;
+  }
+
+  int receive(uint8_t* data, uint8_t cap) override {
+    if (!pending_ || hostsim::nowUs() < replyUs_ || cap < 48) return 0;
+    pending_ = false;
+    const int64_t t2 = static_cast<int64_t>(utcAtZeroUs_ + arriveUs_) + offsetUs_;
+    std::memset(data, 0, 48);
+    data[0] = 0x24;                    // LI 0, VN 4, mode 4 (server)
+    data[1] = 2;                       // stratum
+    std::memcpy(data + 24, token_, 8); // originate = our transmit token
+    putTs_(data + 32, static_cast<uint64_t>(t2));
+    putTs_(data + 40, static_cast<uint64_t>(t2) + kProcUs);
+    return 48;
+  }
+
+private:
+  static constexpr uint32_t kProcUs = 50;
+
+  static void putTs_(uint8_t* p, uint64_t unixUs) {
+    const uint64_t sec  = unixUs / 1000000U + 2208988800ULL;
+    const uint64_t frac = ((unixUs % 1000000U) << 32) / 1000000U;
+    const uint64_t ts   = (sec << 32) | frac;
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(ts >> (56 - 8 * i));
+  }
+
+  uint32_t rand_() {
+    if (!jitterUs_) return 0;
+    lcg_ = lcg_ * 1664525U + 1013904223U;
+    return (lcg_ >> 8) % (jitterUs_ + 1U);
+  }
+
+  uint32_t queue_() {
+    if (!queueUs_) return 0;
+    lcg_ = lcg_ * 1664525U + 1013904223U;
+    if ((lcg_ >> 8) % 100U >= queuePct_) return 0;
+    lcg_ = lcg_ * 1664525U + 1013904223U;
+    return (lcg_ >> 8) % (queueUs_ + 1U);
+  }
+
+  uint64_t utcAtZeroUs_;
+  uint32_t upUs_ = 1000, downUs_ = 1000, jitterUs_ = 0, queueUs_ = 0;
+  uint8_t  queuePct_ = 0;
+  int64_t  offsetUs_ = 0;
+  bool     responding_ = true;
+  uint32_t lcg_ = 1;
+
+  uint8_t  token_[8] = {};
+  bool     pending_ = false;
+  uint64_t arriveUs_ = 0, replyUs_ = 0;
+  uint32_t requests_ = 0;
+};
+
+}
+}
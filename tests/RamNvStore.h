@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "INvStore.h"
+
+namespace sunlix {
+namespace test {
+
+/// INvStore in a RAM array (no file I/O, no heap).
+template <uint16_t N>
+class RamNvStore final : public INvStore {
+public:
+  RamNvStore() { std::memset(mem_, 0xFF, N); }
+  uint16_t size() const override { return N; }
+  bool read(uint16_t addr, uint8_t* buf, uint16_t len) override {
+    if (static_cast<uint32_t>(addr) + len > N) return false;
+    std::memcpy(buf, mem_ + addr, len);
+    return true;
+  }
+  bool write(uint16_t addr, const uint8_t* buf, uint16_t len) override {
+    if (static_cast<uint32_t>(addr) + len > N) return false;
+    std::memcpy(mem_ + addr, buf, len);
+    return true;
+  }
+private:
+  uint8_t mem_[N];
+};
+
+}
+}
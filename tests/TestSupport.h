@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdio>
+#include <cstdint>
+#include "TimeHal.h"
+
+/**
+ * @file TestSupport.h
+ * @brief Minimal check macros for the host tests (no framework dependency).
+ *
+ * Notes:
+ *  - CHECK* record a failure and keep going; return TEST_RESULT() from main().
+ *  - The simulation and uptime::millis64()/micros64() are process-global: a test that
+ *    restarts the simulation must not move virtual time backwards (see freshSim()).
+ */
+
+namespace sunlix {
+namespace test {
+
+  inline int& failures() { static int n = 0; return n; }
+
+  /// Clear ISRs/pending edges and start again a little later in virtual time.
+  inline void freshSim() { hostsim::reset(hostsim::nowUs() + 1000000ULL); }
+
+}
+}
+
+#define CHECK(cond)                                                                     \
+  do {                                                                                  \
+    if (!(cond)) {                                                                      \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);     \
+      ++sunlix::test::failures();                                                       \
+    }                                                                                   \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tol)                                                           \
+  do {                                                                                  \
+    const double a_ = static_cast<double>(a), b_ = static_cast<double>(b);              \
+    const double d_ = a_ > b_ ? a_ - b_ : b_ - a_;                                      \
+    if (d_ > static_cast<double>(tol)) {                                                \
+      std::fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s, %s) failed: %.3f vs %.3f\n",     \
+                   __FILE__, __LINE__, #a, #b, #tol, a_, b_);                           \
+      ++sunlix::test::failures();                                                       \
+    }                                                                                   \
+  } while (0)
+
+#define TEST_RESULT()                                                                   \
+  (sunlix::test::failures() == 0                                                        \
+     ? (std::printf("OK\n"), 0)                                                         \
+     : (std::printf("%d check(s) failed\n", sunlix::test::failures()), 1))
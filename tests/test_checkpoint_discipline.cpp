@@ -0,0 +1,112 @@
+// A discipline rate restored from a checkpoint is anchored at the provider's time on boot
+// (never integrated from the epoch), survives the first NTP step and is ignored when
+// discipline is off.
+#include "TimeService.h"
+#include "TimeCheckpoint.h"
+#include "FakeNtpServer.h"
+#include "RamNvStore.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint32_t kCkptSec = 1760000000UL;
+
+static void saveCheckpoint(INvStore& nv, int32_t discFreqPpb) {
+  TimeCheckpoint ck(&nv);
+  TimeCheckpoint::Data d;
+  d.unixSec     = kCkptSec;
+  d.discFreqPpb = discFreqPpb;
+  CHECK(ck.save(d));
+}
+
+static uint64_t nowUs(TimeService& ts) {
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  return us;
+}
+
+static int64_t diffUs(uint64_t a, uint64_t b) { return static_cast<int64_t>(a - b); }
+
+// RTC running 20 ppm fast; the checkpoint holds the rate learned for it last boot.
+static void rtcBoot() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(kCkptSec));
+  rtc.setDriftPpb(20000);
+  const uint64_t trueAtSet = static_cast<uint64_t>(kCkptSec) * 1000000ULL - hostsim::nowUs();
+  test::RamNvStore<96> nv;
+  saveCheckpoint(nv, -20000);
+  test::FakeNtpServer srv(trueAtSet);
+
+  TimeService::Config c;
+  c.rtc          = &rtc;
+  c.nvStore      = &nv;
+  c.discipline   = true;
+  c.ntpTransport = &srv;
+  c.ntpOnBegin   = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  CHECK(ts.clockDiscipline().freqPpb() == -20000);
+
+  // No jump at boot: reported time is the RTC's
+  CHECK_NEAR(diffUs(nowUs(ts), srv.trueUtcUs()), 0, 2000);
+
+  // 1000 s later the RTC gained 20 ms; the restored rate takes it out
+  hostsim::advanceUs(1000ULL * 1000000ULL);
+  CHECK_NEAR(diffUs(nowUs(ts), srv.trueUtcUs()), 0, 2000);
+
+  // First sync steps the RTC and keeps the restored rate
+  CHECK(ts.ntpSyncStart());
+  for (int i = 0; i < 5000 && ts.ntpStep() != TimeService::NtpStep::Done
+                            && ts.ntpStep() != TimeService::NtpStep::Failed; ++i) {
+    hostsim::advanceUs(1000);
+    ts.poll();
+  }
+  CHECK(ts.ntpStep() == TimeService::NtpStep::Done);
+  CHECK(ts.clockDiscipline().freqPpb() == -20000);
+  hostsim::advanceUs(1000ULL * 1000000ULL);
+  CHECK_NEAR(diffUs(nowUs(ts), srv.trueUtcUs()), 0, 3000);
+}
+
+// Uptime-only boot: the checkpoint time is restored and the rate must not multiply the epoch.
+static void uptimeBoot() {
+  test::freshSim();
+  test::RamNvStore<96> nv;
+  saveCheckpoint(nv, 20000);
+
+  TimeService::Config c;
+  c.nvStore    = &nv;
+  c.discipline = true;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  CHECK_NEAR(diffUs(nowUs(ts), static_cast<uint64_t>(kCkptSec) * 1000000ULL), 0, 1000);
+  hostsim::advanceUs(100ULL * 1000000ULL);
+  CHECK_NEAR(diffUs(nowUs(ts), static_cast<uint64_t>(kCkptSec + 100U) * 1000000ULL), 2000, 1000);
+}
+
+// Discipline off: a stored rate is not applied.
+static void disciplineOff() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(kCkptSec));
+  const uint64_t setUs = hostsim::nowUs();
+  test::RamNvStore<96> nv;
+  saveCheckpoint(nv, -20000);
+
+  TimeService::Config c;
+  c.rtc     = &rtc;
+  c.nvStore = &nv;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  CHECK(ts.clockDiscipline().freqPpb() == 0);
+  hostsim::advanceUs(1000ULL * 1000000ULL);
+  const uint64_t trueUs = static_cast<uint64_t>(kCkptSec) * 1000000ULL + (hostsim::nowUs() - setUs);
+  CHECK_NEAR(diffUs(nowUs(ts), trueUs), 0, 2000);
+}
+
+int main() {
+  rtcBoot();
+  uptimeBoot();
+  disciplineOff();
+  return TEST_RESULT();
+}
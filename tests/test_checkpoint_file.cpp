@@ -0,0 +1,82 @@
+// Checkpoints on the host FileNvStore survive a reboot: a second store on the same file
+// (fresh process state) restores what the first one saved, and writeCount() reports only
+// the bytes a save actually changed.
+#include <cstdio>
+#include "TimeService.h"
+#include "TimeCheckpoint.h"
+#include "CivilTime.h"
+#include "hal/FileNvStore.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const char*    kPath        = "test_checkpoint_file.bin";
+static const uint16_t kSize        = 4 * TimeCheckpoint::kSlotSize;
+static const uint64_t kUtcAtZeroUs = 1760000000ULL * 1000000ULL + 250000ULL;
+
+static bool fetchUtc(sunlix::DateTime& out) {
+  civil::fromUnixMs((kUtcAtZeroUs + hostsim::nowUs()) / 1000U, out);
+  return true;
+}
+
+static void rebootRestores() {
+  test::freshSim();
+  std::remove(kPath);
+
+  // Boot 1: sync (which checkpoints), then force one more
+  uint32_t savedSec = 0;
+  {
+    hostsim::FileNvStore nv(kPath, kSize);
+    TimeService::Config c;
+    c.nvStore             = &nv;
+    c.ntpFetchUtc         = fetchUtc;
+    c.ntpOnBegin          = false;
+    c.uptimeCorrectionPpb = 1234;
+    TimeService ts(c);
+    CHECK(ts.begin());
+    CHECK(nv.writeCount() == 0);                  // nothing stored yet: begin() only reads
+    CHECK(ts.ntpSync());
+    const uint32_t first = nv.writeCount();
+    CHECK(first > 0 && first <= TimeCheckpoint::kSlotSize);
+
+    hostsim::advanceUs(5'000'000ULL);
+    CHECK(ts.checkpoint(true));                   // next slot: at most one slot of bytes
+    CHECK(nv.writeCount() > first && nv.writeCount() <= 2U * TimeCheckpoint::kSlotSize);
+    savedSec = static_cast<uint32_t>((kUtcAtZeroUs + hostsim::nowUs()) / 1000000ULL);
+  }
+
+  // Boot 2: a new store object on the same file, uptime only
+  hostsim::advanceUs(60'000'000ULL);                // powered off for a minute
+  hostsim::FileNvStore nv(kPath, kSize);
+  TimeCheckpoint ck(&nv);
+  TimeCheckpoint::Data d;
+  CHECK(ck.load(d));
+  CHECK(ck.seq() == 2);
+  CHECK(d.unixSec == savedSec);
+  CHECK(d.uptimeCorrPpb == 1234);
+
+  TimeService::Config c;
+  c.nvStore = &nv;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  uint64_t ms = 0;
+  CHECK(ts.nowUnixMs(ms));
+  std::printf("restored %u s (saved %u s), correction %ld ppb\n",
+              static_cast<unsigned>(ms / 1000U), static_cast<unsigned>(savedSec),
+              static_cast<long>(ts.uptimeCorrectionPpb()));
+  CHECK(ms / 1000U == savedSec);                   // stored time, late by the power-off
+  CHECK(ts.uptimeCorrectionPpb() == 1234);
+
+  // Wear: rewriting identical bytes changes none
+  uint8_t slot[TimeCheckpoint::kSlotSize];
+  CHECK(nv.read(0, slot, sizeof(slot)));
+  CHECK(nv.write(0, slot, sizeof(slot)));
+  CHECK(nv.writeCount() == 0);
+
+  std::remove(kPath);
+}
+
+int main() {
+  rebootRestores();
+  return TEST_RESULT();
+}
@@ -0,0 +1,61 @@
+// Closed-form civil calendar against a day-by-day reference over the whole uint32 range.
+#include "CivilTime.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static bool leap(uint32_t y) { return (y % 4U == 0 && y % 100U != 0) || y % 400U == 0; }
+
+static uint8_t monthDays(uint32_t y, uint8_t m) {
+  static const uint8_t kDays[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  return (m == 2 && leap(y)) ? 29 : kDays[m - 1];
+}
+
+static void everyDay() {
+  uint16_t y = 1970;
+  uint8_t  m = 1, d = 1;
+  const uint32_t lastDay = 0xFFFFFFFFUL / civil::kSecondsPerDay;   // 2106-02-07
+  for (uint32_t days = 0; days <= lastDay; ++days) {
+    uint16_t yy = 0;
+    uint8_t  mm = 0, dd = 0;
+    civil::civilFromDays(days, yy, mm, dd);
+    if (yy != y || mm != m || dd != d) {
+      std::fprintf(stderr, "day %u: got %u-%u-%u, want %u-%u-%u\n", days, yy, mm, dd, y, m, d);
+      ++test::failures();
+      return;
+    }
+    if (civil::daysFromCivil(y, m, d) != days) {
+      std::fprintf(stderr, "daysFromCivil(%u-%u-%u) != %u\n", y, m, d, days);
+      ++test::failures();
+      return;
+    }
+    if (++d > monthDays(y, m)) { d = 1; if (++m > 12) { m = 1; ++y; } }
+  }
+}
+
+static void secondsAndMillis() {
+  uint32_t s = 0;
+  for (int i = 0; i < 200000; ++i) {
+    s = s * 1664525U + 1013904223U;                 // spread over the whole range
+    sunlix::DateTime t{};
+    civil::fromUnix(s, t);
+    CHECK(civil::toUnix(t) == s);
+    CHECK(t.hour < 24 && t.minute < 60 && t.second < 60 && t.millis == 0);
+  }
+
+  sunlix::DateTime t{};
+  civil::fromUnixMs(1760000000123ULL, t);
+  CHECK(t.year == 2025 && t.month == 10 && t.day == 9);
+  CHECK(t.hour == 8 && t.minute == 53 && t.second == 20 && t.millis == 123);
+  CHECK(civil::toUnixMs(t) == 1760000000123ULL);
+
+  for (uint32_t us = 0; us < 1000000UL; ++us) {
+    if (civil::usToMs(us) != us / 1000U) { CHECK(civil::usToMs(us) == us / 1000U); break; }
+  }
+}
+
+int main() {
+  everyDay();
+  secondsAndMillis();
+  return TEST_RESULT();
+}
@@ -0,0 +1,62 @@
+// Discipline mode on the RTC provider: the first sync steps the DS3231 (phase kept), later
+// syncs only see the chip's drift and are slewed in; the learned rate takes the drift out.
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint64_t kUtcAtZeroUs = 1760000000ULL * 1000000ULL + 654321ULL;
+
+// Run one sync to completion; true if it stepped the provider (went through Rebind).
+static bool syncOnce(TimeService& ts) {
+  bool stepped = false;
+  CHECK(ts.ntpSyncStart());
+  for (int i = 0; i < 5000 && ts.ntpStep() != TimeService::NtpStep::Done
+                            && ts.ntpStep() != TimeService::NtpStep::Failed; ++i) {
+    hostsim::advanceUs(1000);
+    ts.poll();
+    if (ts.ntpStep() == TimeService::NtpStep::Rebind) stepped = true;
+  }
+  CHECK(ts.ntpStep() == TimeService::NtpStep::Done);
+  return stepped;
+}
+
+int main() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(1700000000UL));
+  rtc.setDriftPpb(20000);                          // +20 ppm: 5 ms per 256 s interval
+  rtc.setJitterUs(10);
+  test::FakeNtpServer srv(kUtcAtZeroUs);
+  srv.setDelayUs(2000, 2000);
+  srv.setJitterUs(100);
+
+  TimeService::Config c;
+  c.rtc          = &rtc;
+  c.asyncBind    = true;
+  c.ntpTransport = &srv;
+  c.ntpBurst     = 4;
+  c.ntpOnBegin   = false;
+  c.discipline   = true;
+  TimeService ts(c);
+  CHECK(ts.begin());
+
+  CHECK(syncOnce(ts));                             // years off: step
+  int steps = 0;
+  int64_t lastAbs = 0;
+  for (int k = 0; k < 12; ++k) {
+    hostsim::advanceUs(256'000'000ULL);
+    if (syncOnce(ts)) ++steps;
+    const int64_t off = ts.ntpLastOffsetUs();
+    lastAbs = off < 0 ? -off : off;
+    std::printf("sync %2d: offset %7lld us, freq %6ld ppb\n", k + 1, static_cast<long long>(off),
+                static_cast<long>(ts.clockDiscipline().freqPpb()));
+  }
+  CHECK(steps == 0);                               // every later offset was slewed in
+  CHECK(lastAbs < 1000);                           // rate learned: residual ≪ 5 ms/interval
+  const int32_t f = ts.clockDiscipline().freqPpb();
+  CHECK(f < -15000 && f > -25000);
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Rtc);
+  return TEST_RESULT();
+}
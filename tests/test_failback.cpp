@@ -0,0 +1,145 @@
+// Failover: health probes, and recovery. An RTC that lost its time during the outage is
+// rewritten from the uptime time before it is used again; a bind never hides a set OSF flag.
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint32_t kSetSec = 1760000000UL;
+
+static int64_t errorUs(TimeService& ts, uint64_t setLocalUs) {
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  const uint64_t trueUs = static_cast<uint64_t>(kSetSec) * 1000000ULL + (hostsim::nowUs() - setLocalUs);
+  return static_cast<int64_t>(us - trueUs);
+}
+
+static void runMs(TimeService& ts, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; ++i) {
+    hostsim::advanceUs(1000);
+    ts.poll();
+  }
+}
+
+// The chip drops off the bus, then comes back with `comeBack` applied to it.
+template <typename F>
+static void outage(const char* name, F comeBack) {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(kSetSec));
+  const uint64_t setLocalUs = hostsim::nowUs();
+
+  TimeService::Config c;
+  c.rtc       = &rtc;
+  c.asyncBind = true;
+  c.failover  = true;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  runMs(ts, 3000);
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Rtc);
+
+  rtc.setResponding(false);
+  runMs(ts, 5000);
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Uptime);
+
+  rtc.setResponding(true);
+  comeBack(rtc);
+  runMs(ts, 10000);
+
+  const int64_t e = errorUs(ts, setLocalUs);
+  std::printf("%s: active=%s status=%d error=%lld us\n", name,
+              ts.activeProvider() == TimeService::ActiveProvider::Rtc ? "rtc" : "uptime",
+              static_cast<int>(ts.status()), static_cast<long long>(e));
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Rtc);
+  CHECK(ts.status() == TimeStatus::Ok);
+  CHECK_NEAR(e, 0, 5000);
+  CHECK(!rtc.lostPower());
+  const int64_t chipErrS = static_cast<int64_t>(rtc.now().unixtime())
+                         - static_cast<int64_t>(kSetSec + (hostsim::nowUs() - setLocalUs) / 1000000ULL);
+  CHECK(chipErrS >= -1 && chipErrS <= 1);
+}
+
+// Health checks probe the bus address only: no rtc->begin() (RTClib re-creates its device there).
+static void probeIsAddressOnly() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(kSetSec));
+
+  TimeService::Config c;
+  c.rtc       = &rtc;
+  c.asyncBind = true;
+  c.failover  = true;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  const uint32_t begins = rtc.beginCalls();
+  const uint32_t probes = Wire.transmissions();
+  runMs(ts, 10000);
+  CHECK(rtc.beginCalls() == begins);
+  CHECK(Wire.transmissions() - probes >= 9);
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Rtc);
+}
+
+// SQW dies while an NTP sync waits for the RTC re-bind, with no bind timeout: the health
+// check still runs, fails over with the NTP time, and the sync ends instead of hanging.
+static void deadSqwDuringRebind() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(1700000000UL));
+  test::FakeNtpServer srv(static_cast<uint64_t>(kSetSec) * 1000000ULL);
+
+  TimeService::Config c;
+  c.rtc           = &rtc;
+  c.asyncBind     = true;
+  c.bindTimeoutMs = 0;
+  c.failover      = true;
+  c.ntpTransport  = &srv;
+  c.ntpOnBegin    = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  runMs(ts, 3000);
+  CHECK(ts.ntpSyncStart());
+  rtc.setSqwRunning(false);
+  runMs(ts, 8000);
+
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  CHECK(ts.activeProvider() == TimeService::ActiveProvider::Uptime);
+  CHECK(ts.ntpStep() == TimeService::NtpStep::Failed);
+  CHECK_NEAR(static_cast<int64_t>(us - srv.trueUtcUs()), 0, 5000);
+}
+
+// A bind completing on a chip with OSF set keeps reporting LostPower.
+static void bindKeepsLostPower() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(kSetSec));
+  rtc.setLostPower(true);
+
+  RtcDateTimeProvider::Config c;
+  c.rtc       = &rtc;
+  c.asyncBind = true;
+  RtcDateTimeProvider p(c);
+  CHECK(p.begin());
+  for (int i = 0; i < 3000 && p.poll() == RtcDateTimeProvider::BindState::Pending; ++i) {
+    hostsim::advanceUs(1000);
+  }
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+  CHECK(p.status() == TimeStatus::LostPower);
+}
+
+int main() {
+  // Brown-out: back at 2000-01-01 with OSF set
+  outage("brown-out", [](RTC_DS3231& rtc) {
+    rtc.adjust(::DateTime(946684800UL));
+    rtc.setLostPower(true);
+  });
+  // OSF clear but the time is two days off
+  outage("implausible", [](RTC_DS3231& rtc) {
+    rtc.adjust(::DateTime(rtc.now().unixtime() + 2U * 86400U));
+  });
+  probeIsAddressOnly();
+  deadSqwDuringRebind();
+  bindKeepsLostPower();
+  return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+// Host simulation itself: virtual clock, simulated DS3231 and ISR delivery.
+#include "TimeHal.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+namespace {
+  uint32_t g_edges  = 0;
+  uint32_t g_lastUs = 0;
+  void onEdge() { ++g_edges; g_lastUs = micros(); }
+}
+
+static void virtualClock() {
+  hostsim::reset(5000);
+  CHECK(micros() == 5000);
+  hostsim::advanceUs(1500);
+  CHECK(micros() == 6500);
+  CHECK(millis() == 6);
+  delay(2);
+  CHECK(micros() == 8500);
+  delayMicroseconds(10);
+  CHECK(hostsim::nowUs() == 8510);
+}
+
+static void sqwEdgesAndDrift() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.setSqwPin(3);
+  rtc.adjust(::DateTime(1700000000UL));      // restarts the countdown chain now
+  rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+  rtc.setDriftPpb(100000);                   // +100 ppm: each second 100 µs short
+  attachInterrupt(digitalPinToInterrupt(3), onEdge, RISING);
+  g_edges = 0;
+
+  const uint64_t t0 = hostsim::nowUs();
+  hostsim::advanceUs(100'000'000ULL);
+  CHECK(g_edges == 100);
+  CHECK(rtc.now().unixtime() == 1700000100UL);
+  CHECK(static_cast<uint32_t>(g_lastUs - static_cast<uint32_t>(t0)) == 100U * 999'900U);
+  CHECK(hostsim::lastEdgeUs(3) == t0 + 100U * 999'900U);
+
+  // ISR latency jitter moves what the ISR sees, not the latched edge time
+  rtc.setJitterUs(50);
+  for (int i = 0; i < 20; ++i) {
+    hostsim::advanceUs(1'000'000);
+    const uint32_t late = g_lastUs - static_cast<uint32_t>(hostsim::lastEdgeUs(3));
+    CHECK(late <= 50);
+  }
+  detachInterrupt(digitalPinToInterrupt(3));
+}
+
+static void isrDelivery() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.setSqwPin(4);
+  rtc.adjust(::DateTime(1700000000UL));
+  rtc.writeSqwPinMode(DS3231_SquareWave1Hz);
+  attachInterrupt(digitalPinToInterrupt(4), onEdge, RISING);
+  g_edges = 0;
+
+  // Masked: edges latch once per pin and arrive on interrupts()
+  noInterrupts();
+  hostsim::advanceUs(3'500'000);
+  CHECK(g_edges == 0);
+  interrupts();
+  CHECK(g_edges == 1);
+
+  // Delivery off: edges are lost, the chip keeps counting seconds
+  hostsim::setIsrDelivery(false);
+  hostsim::advanceUs(2'000'000);
+  CHECK(g_edges == 1);
+  hostsim::setIsrDelivery(true);
+  CHECK(rtc.now().unixtime() == 1700000005UL);
+
+  // Wire cut: no edges at all
+  rtc.setSqwRunning(false);
+  const uint32_t before = rtc.edgesGenerated();
+  hostsim::advanceUs(2'000'000);
+  CHECK(rtc.edgesGenerated() == before);
+  rtc.setSqwRunning(true);
+
+  // kHz output
+  rtc.writeSqwPinMode(DS3231_SquareWave1kHz);
+  g_edges = 0;
+  hostsim::advanceUs(1'000'000);
+  CHECK(g_edges >= 1023 && g_edges <= 1025);
+  detachInterrupt(digitalPinToInterrupt(4));
+}
+
+static void busAndPower() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  CHECK(rtc.begin());
+  CHECK(!rtc.lostPower());
+  rtc.setLostPower(true);
+  CHECK(rtc.lostPower());
+  rtc.adjust(::DateTime(1700000000UL));      // writing the time clears OSF
+  CHECK(!rtc.lostPower());
+
+  rtc.setResponding(false);
+  CHECK(!rtc.begin());
+  CHECK(rtc.now().unixtime() == 0);
+  rtc.setResponding(true);
+  CHECK(rtc.now().unixtime() == 1700000000UL);
+}
+
+int main() {
+  virtualClock();
+  sqwEdgesAndDrift();
+  isrDelivery();
+  busAndPower();
+  return TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+// TimeService never allocates: construction, begin(), poll() and NTP syncs with every
+// optional feature switched on run with operator new and malloc counted.
+#include <cstdlib>
+#include <new>
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "RamNvStore.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+#if defined(__GLIBC__)
+extern "C" {
+  void* __libc_malloc(std::size_t);
+  void* __libc_calloc(std::size_t, std::size_t);
+  void* __libc_realloc(void*, std::size_t);
+}
+#endif
+
+namespace {
+  bool g_armed  = false;
+  long g_allocs = 0;
+
+  void* counted(std::size_t n) {
+    if (g_armed) ++g_allocs;
+#if defined(__GLIBC__)
+    void* p = __libc_malloc(n ? n : 1);      // not via malloc(): counted once
+#else
+    void* p = std::malloc(n ? n : 1);
+#endif
+    if (!p) throw std::bad_alloc();
+    return p;
+  }
+}
+
+// --- operator new/delete (all throwing/nothrow, scalar/array forms) ---
+void* operator new(std::size_t n)                                { return counted(n); }
+void* operator new[](std::size_t n)                              { return counted(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept   { try { return counted(n); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { try { return counted(n); } catch (...) { return nullptr; } }
+void  operator delete(void* p) noexcept                          { std::free(p); }
+void  operator delete[](void* p) noexcept                        { std::free(p); }
+void  operator delete(void* p, std::size_t) noexcept             { std::free(p); }
+void  operator delete[](void* p, std::size_t) noexcept           { std::free(p); }
+
+// --- C allocator (glibc: forward to the real implementation) ---
+#if defined(__GLIBC__)
+extern "C" {
+  void* malloc(std::size_t n)                { if (g_armed) ++g_allocs; return __libc_malloc(n); }
+  void* calloc(std::size_t c, std::size_t n) { if (g_armed) ++g_allocs; return __libc_calloc(c, n); }
+  void* realloc(void* p, std::size_t n)      { if (g_armed) ++g_allocs; return __libc_realloc(p, n); }
+}
+#endif
+
+int main() {
+  hostsim::reset(1000);
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(1760000000UL));
+  rtc.setDriftPpb(20000);
+  test::FakeNtpServer a(1760000000ULL * 1000000ULL), b(1760000000ULL * 1000000ULL);
+  test::RamNvStore<256> nv;
+
+  // Sanity: the counter sees both allocators
+  static int* volatile  keepNew;
+  static void* volatile keepMalloc;
+  g_armed = true;
+  keepNew    = new int(1);
+  keepMalloc = std::malloc(8);
+  g_armed = false;
+  delete keepNew;
+  std::free(keepMalloc);
+#if defined(__GLIBC__)
+  CHECK(g_allocs == 2);
+#else
+  CHECK(g_allocs == 1);
+#endif
+  g_allocs = 0;
+
+  bool synced = false;
+  g_armed = true;
+  {
+    TimeService::Config c;
+    c.rtc          = &rtc;
+    c.ntpServers[0] = &a;
+    c.ntpServers[1] = &b;
+    c.ntpBurst     = 4;
+    c.ntpAutoSync  = true;
+    c.ntpMinIntervalS = 64;
+    c.discipline   = true;
+    c.failover     = true;
+    c.nvStore      = &nv;
+    c.checkpointIntervalS = 60;
+
+    TimeService ts(c);
+    (void)ts.begin();
+    for (int i = 0; i < 600'000; ++i) {          // 10 min in 1 ms steps: several syncs
+      hostsim::advanceUs(1000);
+      ts.poll();
+      uint64_t us = 0;
+      sunlix::DateTime dt{};
+      (void)ts.nowUnixUs(us);
+      (void)ts.nowUtc(dt);
+    }
+    (void)ts.ntpSync();
+    (void)ts.checkpoint(true);
+    synced = ts.ntpEverSynced() && ts.activeProvider() == TimeService::ActiveProvider::Rtc;
+  }
+  g_armed = false;
+
+  CHECK(synced);
+  CHECK(a.requests() > 4 && b.requests() > 4);
+  CHECK(g_allocs == 0);
+  std::printf("allocations=%ld requests=%u+%u\n", g_allocs, a.requests(), b.requests());
+  return TEST_RESULT();
+}
@@ -0,0 +1,68 @@
+// NTP burst clock filter: the minimum-delay sample of the burst is applied, so queueing
+// jitter on the path mostly cancels.
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint64_t kUtcAtZeroUs = 1760000000ULL * 1000000ULL + 314159ULL;
+
+static int64_t errorUs(TimeService& ts, const test::FakeNtpServer& ref) {
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  return static_cast<int64_t>(us - ref.trueUtcUs());
+}
+
+static bool runSync(TimeService& ts) {
+  if (!ts.ntpSyncStart()) return false;
+  for (int i = 0; i < 20000 && ts.ntpStep() != TimeService::NtpStep::Done
+                             && ts.ntpStep() != TimeService::NtpStep::Failed; ++i) {
+    hostsim::advanceUs(200);
+    ts.poll();
+  }
+  return ts.ntpStep() == TimeService::NtpStep::Done;
+}
+
+// Mean |error| right after each of 40 syncs through a path where half the legs queue for up
+// to 30 ms.
+static int64_t jitteryPath(uint8_t burst) {
+  test::freshSim();
+  test::FakeNtpServer srv(kUtcAtZeroUs);
+  srv.setDelayUs(2000, 2000);
+  srv.setJitterUs(200);
+  srv.setQueueUs(30000, 50);
+  srv.setSeed(7);
+
+  TimeService::Config c;
+  c.ntpTransport = &srv;
+  c.ntpBurst     = burst;
+  c.ntpOnBegin   = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+
+  int64_t sum = 0, worst = 0;
+  for (int k = 0; k < 40; ++k) {
+    hostsim::advanceUs(5'000'000);
+    CHECK(runSync(ts));
+    const int64_t e = errorUs(ts, srv);
+    sum += e < 0 ? -e : e;
+    if ((e < 0 ? -e : e) > worst) worst = e < 0 ? -e : e;
+
+    // The applied sample is the minimum-delay one of the burst
+    const NtpClockFilter& f = ts.ntpFilter();
+    CHECK(f.count() == burst);
+    for (uint8_t i = 0; i < f.count(); ++i) CHECK(ts.ntpLastDelayUs() <= f.entry(i).delayUs);
+  }
+  std::printf("burst %u: mean |error| after sync %lld us, worst %lld us\n", burst,
+              static_cast<long long>(sum / 40), static_cast<long long>(worst));
+  return sum / 40;
+}
+
+int main() {
+  const int64_t single = jitteryPath(1);
+  const int64_t best8  = jitteryPath(8);
+  CHECK(best8 < 1500);
+  CHECK(best8 * 4 < single);
+  return TEST_RESULT();
+}
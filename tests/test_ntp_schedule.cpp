@@ -0,0 +1,60 @@
+// First scheduled sync: boards booted at the same instant with the same time spread out by
+// their ntpJitterSeed, and the delay stays within 0..ntpFirstSyncJitterS.
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "UptimeClock.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint64_t kUtcAtZeroUs = 1760000000ULL * 1000000ULL;
+static const uint16_t kJitterS     = 600;
+
+// Restart the simulation at the same micros() as every other board (next 2^32 µs turn).
+static void bootTogether() {
+  hostsim::reset((((hostsim::nowUs() >> 32) + 1) << 32) + 5'000'000ULL);
+  uptime::poll();
+}
+
+// millis() after begin() at which the scheduler starts the first sync.
+static uint32_t firstSyncMs(uint32_t seed) {
+  bootTogether();
+  test::FakeNtpServer srv(kUtcAtZeroUs);
+  TimeService::Config c;
+  c.ntpTransport        = &srv;
+  c.ntpOnBegin          = false;
+  c.ntpAutoSync         = true;
+  c.ntpFirstSyncJitterS = kJitterS;
+  c.ntpJitterSeed       = seed;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  const uint32_t t0 = millis();
+  for (uint32_t i = 0; i <= kJitterS * 10U + 10U; ++i) {
+    ts.poll();
+    if (ts.ntpStep() != TimeService::NtpStep::Idle) return millis() - t0;
+    hostsim::advanceUs(100'000);
+  }
+  return UINT32_MAX;
+}
+
+static void seedSpreadsFleet() {
+  const uint32_t unseeded = firstSyncMs(0);     // the fleet as it was: one draw for all
+  CHECK(firstSyncMs(0) == unseeded);
+
+  static const int kBoards = 16;
+  uint32_t at[kBoards];
+  int clashes = 0;
+  for (int b = 0; b < kBoards; ++b) {
+    at[b] = firstSyncMs(0x00A1B2C0UL + static_cast<uint32_t>(b));   // consecutive MACs
+    CHECK(at[b] <= kJitterS * 1000U + 100U);
+    for (int k = 0; k < b; ++k) if (at[b] / 1000U == at[k] / 1000U) ++clashes;
+  }
+  std::printf("%d boards, same boot instant: %d pairs in the same second\n", kBoards, clashes);
+  CHECK(clashes <= 2);                 // ~0.2 expected for 16 draws over 600 s
+  CHECK(firstSyncMs(0x00A1B2C0UL) == at[0]);  // same board, same boot: same draw
+}
+
+int main() {
+  seedSpreadsFleet();
+  return TEST_RESULT();
+}
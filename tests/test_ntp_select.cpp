@@ -0,0 +1,76 @@
+// Multi-server NTP selection: a falseticker is outvoted, a split vote is refused.
+#include "TimeService.h"
+#include "FakeNtpServer.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint64_t kUtcAtZeroUs = 1760000000ULL * 1000000ULL + 314159ULL;
+
+static int64_t errorUs(TimeService& ts, const test::FakeNtpServer& ref) {
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  return static_cast<int64_t>(us - ref.trueUtcUs());
+}
+
+static bool runSync(TimeService& ts) {
+  if (!ts.ntpSyncStart()) return false;
+  for (int i = 0; i < 20000 && ts.ntpStep() != TimeService::NtpStep::Done
+                             && ts.ntpStep() != TimeService::NtpStep::Failed; ++i) {
+    hostsim::advanceUs(200);
+    ts.poll();
+  }
+  return ts.ntpStep() == TimeService::NtpStep::Done;
+}
+
+// Three servers, one 500 ms off: the majority wins and the falseticker is not a survivor.
+static void falsetickerOutvoted() {
+  test::freshSim();
+  test::FakeNtpServer a(kUtcAtZeroUs), b(kUtcAtZeroUs), bad(kUtcAtZeroUs);
+  b.setDelayUs(3000, 2000);
+  bad.setOffsetUs(500000);
+
+  TimeService::Config c;
+  c.ntpServers[0] = &a;
+  c.ntpServers[1] = &bad;
+  c.ntpServers[2] = &b;
+  c.ntpBurst      = 2;
+  c.ntpOnBegin    = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  CHECK(runSync(ts));
+  CHECK_NEAR(errorUs(ts, a), 0, 2000);
+  CHECK((ts.ntpSelector().survivors() & 0x2U) == 0);
+  CHECK(ts.ntpSelector().survivors() == 0x5U);
+}
+
+// Four servers split 2/2: no majority, the sync fails and the clock is not touched.
+static void splitVoteRefused() {
+  test::freshSim();
+  test::FakeNtpServer a(kUtcAtZeroUs), b(kUtcAtZeroUs), c1(kUtcAtZeroUs), c2(kUtcAtZeroUs);
+  c1.setOffsetUs(-2000000);
+  c2.setOffsetUs(-2000000);
+
+  TimeService::Config c;
+  c.ntpServers[0] = &a;
+  c.ntpServers[1] = &c1;
+  c.ntpServers[2] = &b;
+  c.ntpServers[3] = &c2;
+  c.ntpOnBegin    = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  uint64_t before = 0;
+  CHECK(ts.nowUnixUs(before));
+  const uint64_t beforeLocal = hostsim::nowUs();
+  CHECK(!runSync(ts));
+  CHECK(!ts.ntpEverSynced());
+  uint64_t after = 0;
+  CHECK(ts.nowUnixUs(after));
+  CHECK_NEAR(static_cast<int64_t>(after - before), static_cast<int64_t>(hostsim::nowUs() - beforeLocal), 1000);
+}
+
+int main() {
+  falsetickerOutvoted();
+  splitVoteRefused();
+  return TEST_RESULT();
+}
@@ -0,0 +1,139 @@
+// High-resolution (kHz SQW) mode: the async bind finds the second boundary to within an
+// edge however often loop() polls, and the periodic check repairs edges lost later.
+#include "RtcDateTimeProvider.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint32_t kSetSec   = 1760000000UL;
+static const int32_t  kDriftPpb = 2000;
+
+// Provider time minus the chip's own time (its seconds began when it was written).
+static int64_t errorUs(RtcDateTimeProvider& p, uint64_t setLocalUs) {
+  uint64_t us = 0;
+  CHECK(p.nowUnixUs(us));
+  const double elapsed = static_cast<double>(hostsim::nowUs() - setLocalUs) * 1e9 / (1e9 - kDriftPpb);
+  const double chipUs  = static_cast<double>(kSetSec) * 1e6 + elapsed;
+  return static_cast<int64_t>(static_cast<double>(us) - chipUs);
+}
+
+struct Rig {
+  RTC_DS3231 rtc;
+  uint64_t   setLocalUs = 0;
+  RtcDateTimeProvider::Config cfg;
+
+  Rig(uint16_t hz, bool async) {
+    test::freshSim();
+    rtc.setSqwPin(2);
+    rtc.setDriftPpb(kDriftPpb);
+    rtc.setJitterUs(5);
+    hostsim::advanceUs(123'457);                 // arbitrary phase vs. the MCU clock
+    rtc.adjust(::DateTime(kSetSec));
+    setLocalUs = hostsim::nowUs();
+    cfg.rtc           = &rtc;
+    cfg.sqwHz         = hz;
+    cfg.asyncBind     = async;
+    cfg.bindTimeoutMs = 0;
+    cfg.khzVerifyS    = 2;
+  }
+};
+
+static void asyncBind(uint16_t hz, uint32_t pollUs) {
+  Rig r(hz, true);
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  uint32_t polls = 0;
+  while (p.poll() == RtcDateTimeProvider::BindState::Pending && polls < 10000) {
+    hostsim::advanceUs(pollUs);
+    ++polls;
+  }
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+
+  int64_t worst = 0;
+  for (int i = 0; i < 200; ++i) {               // 10 s, reads at many phases
+    hostsim::advanceUs(50'000 + 137 * i);
+    (void)p.poll();
+    const int64_t e = errorUs(p, r.setLocalUs);
+    if ((e < 0 ? -e : e) > worst) worst = e < 0 ? -e : e;
+  }
+  const int64_t edgeUs = 1000000 / hz;
+  std::printf("%5u Hz, poll %5u us: bound after %.1f s, worst |error| %lld us (edge %lld us)\n",
+              hz, pollUs, polls * pollUs / 1e6, static_cast<long long>(worst), static_cast<long long>(edgeUs));
+  CHECK(worst <= 25);                            // bound to the boundary edge: ISR jitter only
+}
+
+static void blockingBind(uint16_t hz) {
+  Rig r(hz, false);
+  r.cfg.bindTimeoutMs = 1500;                    // default: the predicted second must still fit
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+  CHECK_NEAR(errorUs(p, r.setLocalUs), 0, 1000);
+}
+
+// Edges lost with interrupts masked: the count lags the chip until the check re-bases it.
+static void lostEdgesRepaired(uint16_t hz) {
+  Rig r(hz, true);
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  for (int i = 0; i < 5000 && p.poll() == RtcDateTimeProvider::BindState::Pending; ++i) {
+    hostsim::advanceUs(1000);
+  }
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+
+  hostsim::setIsrDelivery(false);
+  hostsim::advanceUs(5'000);                     // 5 ms of edges dropped
+  hostsim::setIsrDelivery(true);
+  hostsim::advanceUs(10'000);
+  const int64_t before = errorUs(p, r.setLocalUs);
+  CHECK(before < -3000);                         // behind by the lost edges
+
+  for (int i = 0; i < 8000; ++i) {               // > khzVerifyS of 1 ms polls (+ a re-bind)
+    hostsim::advanceUs(1000);
+    (void)p.poll();
+  }
+  const int64_t after = errorUs(p, r.setLocalUs);
+  std::printf("%5u Hz, lost edges: error %lld us before the check, %lld us after\n",
+              hz, static_cast<long long>(before), static_cast<long long>(after));
+  CHECK(p.isBound());
+  CHECK_NEAR(after, 0, 25);
+}
+
+// Longest single poll() over a bind and several boundary checks, with a 1 ms loop.
+static void pollStallBounded(uint16_t hz, uint8_t burstMaxMs) {
+  Rig r(hz, true);
+  r.cfg.khzBurstMaxMs = burstMaxMs;
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  uint64_t worstUs = 0;
+  for (int i = 0; i < 10000; ++i) {              // 10 s: bind + checks every 2 s
+    hostsim::advanceUs(1000);
+    const uint64_t t0 = hostsim::nowUs();
+    (void)p.poll();
+    if (hostsim::nowUs() - t0 > worstUs) worstUs = hostsim::nowUs() - t0;
+  }
+  std::printf("%5u Hz, burst cap %3u ms: longest poll() %llu us\n", hz, burstMaxMs,
+              static_cast<unsigned long long>(worstUs));
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+  CHECK(worstUs <= 5000);                        // two loop() periods + reads, not the cap
+  CHECK(worstUs <= burstMaxMs * 1000ULL + 400);  // cap + the read in flight
+}
+
+int main() {
+  asyncBind(1024, 1000);
+  asyncBind(1024, 7000);
+  asyncBind(1024, 10000);
+  asyncBind(1024, 40000);
+  asyncBind(4096, 10000);
+  asyncBind(8192, 1000);
+  asyncBind(8192, 10000);
+  blockingBind(1024);
+  blockingBind(8192);
+  lostEdgesRepaired(1024);
+  lostEdgesRepaired(8192);
+  pollStallBounded(1024, 130);
+  pollStallBounded(8192, 130);
+  pollStallBounded(1024, 3);
+  pollStallBounded(8192, 3);
+  return TEST_RESULT();
+}
@@ -0,0 +1,65 @@
+// SQW period calibration (trackPeriod) whatever the application's read rate.
+#include "RtcDateTimeProvider.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+// MCU micros() 300 ppm fast vs. the DS3231 == RTC second is 1'000'300 µs of MCU time.
+static void calibrates(uint32_t readEveryMs) {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(1760000000UL));
+  rtc.setDriftPpb(-300000);
+  rtc.setJitterUs(20);
+
+  RtcDateTimeProvider::Config c;
+  c.rtc = &rtc;
+  RtcDateTimeProvider p(c);
+  CHECK(p.begin());
+
+  for (uint32_t t = 0; t < 120'000; t += readEveryMs) {
+    hostsim::advanceUs(static_cast<uint64_t>(readEveryMs) * 1000U);
+    uint64_t us = 0;
+    (void)p.nowUnixUs(us);
+  }
+  std::printf("read every %5u ms: measured=%d period=%u ppm=%d\n", readEveryMs,
+              p.hasMeasuredPeriod(), p.measuredPeriodUs(), p.ppmError());
+  CHECK(p.hasMeasuredPeriod());
+  CHECK_NEAR(p.ppmError(), 300, 5);
+  CHECK_NEAR(p.measuredPeriodUs(), 1'000'300, 5);
+}
+
+// A missed edge (more time than counted edges) must not be averaged into the period.
+static void skipsMissedEdges() {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.adjust(::DateTime(1760000000UL));
+  rtc.setDriftPpb(-300000);
+
+  RtcDateTimeProvider::Config c;
+  c.rtc = &rtc;
+  RtcDateTimeProvider p(c);
+  CHECK(p.begin());
+  for (int i = 0; i < 20; ++i) {
+    hostsim::advanceUs(3'000'000);
+    uint64_t us = 0;
+    (void)p.nowUnixUs(us);
+  }
+  hostsim::setIsrDelivery(false);              // two edges lost
+  hostsim::advanceUs(2'000'000);
+  hostsim::setIsrDelivery(true);
+  hostsim::advanceUs(3'000'000);
+  uint64_t us = 0;
+  (void)p.nowUnixUs(us);
+  CHECK_NEAR(p.ppmError(), 300, 5);
+}
+
+int main() {
+  calibrates(1);
+  calibrates(1000);
+  calibrates(2000);
+  calibrates(5000);
+  calibrates(30000);
+  skipsMissedEdges();
+  return TEST_RESULT();
+}
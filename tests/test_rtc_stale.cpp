@@ -0,0 +1,141 @@
+// Bound 1 Hz path: stale SQW is detected and recovered, and neither the micros() wrap nor
+// hours with only poll() calls move the reported time.
+#include "RtcDateTimeProvider.h"
+#include "TimeService.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint32_t kSetSec = 1760000000UL;
+
+struct Rig {
+  RTC_DS3231 rtc;
+  uint64_t   setLocalUs = 0;
+  RtcDateTimeProvider::Config cfg;
+  Rig() {
+    test::freshSim();
+    rtc.setSqwPin(2);
+    rtc.setJitterUs(10);
+    rtc.adjust(::DateTime(kSetSec));
+    setLocalUs = hostsim::nowUs();
+    cfg.rtc = &rtc;
+  }
+  uint64_t trueUs() const { return static_cast<uint64_t>(kSetSec) * 1000000ULL + (hostsim::nowUs() - setLocalUs); }
+};
+
+static int64_t errorUs(RtcDateTimeProvider& p, const Rig& r) {
+  uint64_t us = 0;
+  CHECK(p.nowUnixUs(us));
+  return static_cast<int64_t>(us - r.trueUs());
+}
+
+static void staleAndBack() {
+  Rig r;
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  hostsim::advanceUs(2'500'000);
+  CHECK_NEAR(errorUs(p, r), 0, 50);
+
+  r.rtc.setSqwRunning(false);                 // wire cut: no edges, chip keeps counting
+  hostsim::advanceUs(10'300'000);
+  uint64_t us = 0;
+  CHECK(p.nowUnixUs(us));
+  CHECK(p.status() == TimeStatus::Stale);
+  CHECK(us / 1000000ULL == r.trueUs() / 1000000ULL);   // I2C seconds, not extrapolation
+  CHECK(us % 1000000ULL == 0);
+
+  // Edges resume: the first one re-arms the bind (the chip may have browned out meanwhile),
+  // the next one completes it
+  r.rtc.setSqwRunning(true);
+  for (int i = 0; i < 2500; ++i) {
+    hostsim::advanceUs(1000);
+    (void)p.poll();
+  }
+  CHECK(p.isBound());
+  CHECK(p.bindState() == RtcDateTimeProvider::BindState::Bound);
+  hostsim::advanceUs(400'000);
+  CHECK(p.status() == TimeStatus::Ok);
+  CHECK_NEAR(errorUs(p, r), 0, 50);
+}
+
+static void acrossMicrosWrap() {
+  Rig r;
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  uint64_t prev = 0;
+  int64_t worst = 0;
+  for (int i = 0; i < 2 * 72 * 600; ++i) {     // 2.4 h in 100 ms steps: two micros() wraps
+    hostsim::advanceUs(100'000);
+    uint64_t us = 0;
+    CHECK(p.nowUnixUs(us));
+    CHECK(us >= prev);
+    prev = us;
+    const int64_t e = static_cast<int64_t>(us - r.trueUs());
+    if ((e < 0 ? -e : e) > worst) worst = e < 0 ? -e : e;
+  }
+  std::printf("two micros() wraps: worst |error| %lld us\n", static_cast<long long>(worst));
+  CHECK(worst <= 50);
+}
+
+// Hours without any read, only poll(): the next read folds them.
+static void longGapBetweenReads() {
+  Rig r;
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  for (int i = 0; i < 6; ++i) {
+    hostsim::advanceUs(30ULL * 60ULL * 1000000ULL);
+    (void)p.poll();
+  }
+  hostsim::advanceUs(333'333);
+  CHECK_NEAR(errorUs(p, r), 0, 50);
+  CHECK(p.status() == TimeStatus::Ok);
+}
+
+// SQW stops and nothing reads for exactly two micros() wraps (+1.5 s): poll() alone must
+// keep the 64-bit clock, or the gap looks like 1.5 s and the time runs two wraps behind.
+static const uint64_t kTwoWrapsUs = 2ULL << 32;
+
+static void sqwStopsOnlyPolls() {
+  Rig r;
+  RtcDateTimeProvider p(r.cfg);
+  CHECK(p.begin());
+  hostsim::advanceUs(10'000);                  // just past the bound edge
+  r.rtc.setSqwRunning(false);
+  const uint64_t until = hostsim::nowUs() + kTwoWrapsUs + 1'500'000ULL;
+  while (hostsim::nowUs() + 30ULL * 60ULL * 1000000ULL < until) {
+    hostsim::advanceUs(30ULL * 60ULL * 1000000ULL);
+    (void)p.poll();
+  }
+  hostsim::advanceUs(until - hostsim::nowUs());
+  CHECK_NEAR(errorUs(p, r), 0, 1000000);       // I2C seconds, not two wraps behind
+  CHECK(p.status() == TimeStatus::Stale);
+}
+
+static void sqwStopsOnlyServicePolls() {
+  Rig r;
+  TimeService::Config c;
+  c.rtc        = &r.rtc;
+  c.ntpOnBegin = false;
+  TimeService ts(c);
+  CHECK(ts.begin());
+  hostsim::advanceUs(10'000);
+  r.rtc.setSqwRunning(false);
+  const uint64_t until = hostsim::nowUs() + kTwoWrapsUs + 1'500'000ULL;
+  while (hostsim::nowUs() + 30ULL * 60ULL * 1000000ULL < until) {
+    hostsim::advanceUs(30ULL * 60ULL * 1000000ULL);
+    ts.poll();
+  }
+  hostsim::advanceUs(until - hostsim::nowUs());
+  uint64_t us = 0;
+  CHECK(ts.nowUnixUs(us));
+  CHECK_NEAR(static_cast<int64_t>(us - r.trueUs()), 0, 1000000);
+}
+
+int main() {
+  staleAndBack();
+  acrossMicrosWrap();
+  longGapBetweenReads();
+  sqwStopsOnlyPolls();
+  sqwStopsOnlyServicePolls();
+  return TEST_RESULT();
+}
@@ -0,0 +1,55 @@
+// EdgeSeqLock under a real concurrent writer: a std::thread stands in for the SQW ISR.
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "EdgeSeqLock.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+namespace {
+  constexpr uint32_t kWrites  = 2'000'000;
+  constexpr int      kReaders = 3;
+
+  // Edge time the writer pairs with each count; a torn read breaks the relation
+  uint32_t timeFor(uint32_t count) { return count * 2654435761U + 12345U * (count != 0); }
+}
+
+int main() {
+  EdgeSeqLock lock;
+  std::atomic<bool> done{false};
+  std::atomic<uint32_t> torn{0}, backwards{0}, reads{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kReaders; ++r) {
+    readers.emplace_back([&] {
+      uint32_t last = 0, n = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        uint32_t count = 0, edgeUs = 0;
+        lock.read(count, edgeUs);
+        if (edgeUs != timeFor(count)) torn.fetch_add(1);
+        if (count < last) backwards.fetch_add(1);
+        last = count;
+        ++n;
+      }
+      reads.fetch_add(n);
+    });
+  }
+
+  std::thread writer([&] {
+    for (uint32_t i = 1; i <= kWrites; ++i) lock.publish(timeFor(i));
+  });
+  writer.join();
+  done.store(true);
+  for (std::thread& t : readers) t.join();
+
+  uint32_t count = 0, edgeUs = 0;
+  lock.read(count, edgeUs);
+  CHECK(count == kWrites);
+  CHECK(edgeUs == timeFor(kWrites));
+  CHECK(torn.load() == 0);
+  CHECK(backwards.load() == 0);
+  CHECK(reads.load() > 0);
+  std::printf("writes=%u reads=%u torn=%u\n", kWrites, reads.load(), torn.load());
+  return TEST_RESULT();
+}
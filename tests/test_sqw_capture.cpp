@@ -0,0 +1,54 @@
+// Input-capture backend: edge times come from the (simulated) capture latch, so ISR latency
+// jitter and masked-interrupt windows no longer reach the reported phase.
+#include "RtcDateTimeProvider.h"
+#include "hal/SimSqwCapture.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint32_t kSetSec = 1760000000UL;
+
+// Mean and worst |error| over 60 s of reads; interrupts masked for 400 µs every 7th read.
+static void run(ISqwCapture* cap, double& meanUs, double& worstUs) {
+  test::freshSim();
+  RTC_DS3231 rtc;
+  rtc.setSqwPin(2);
+  rtc.setJitterUs(200);                        // busy ISR neighbours
+  rtc.adjust(::DateTime(kSetSec));
+  const uint64_t setLocalUs = hostsim::nowUs();
+
+  RtcDateTimeProvider::Config c;
+  c.rtc     = &rtc;
+  c.capture = cap;
+  RtcDateTimeProvider p(c);
+  CHECK(p.begin());
+
+  double sum = 0;
+  worstUs = 0;
+  const int kReads = 60000;
+  for (int i = 0; i < kReads; ++i) {
+    if (i % 7 == 0) { noInterrupts(); hostsim::advanceUs(400); interrupts(); }
+    hostsim::advanceUs(997);
+    uint64_t us = 0;
+    CHECK(p.nowUnixUs(us));
+    const double trueUs = static_cast<double>(kSetSec) * 1e6 + static_cast<double>(hostsim::nowUs() - setLocalUs);
+    double e = static_cast<double>(us) - trueUs;
+    if (e < 0) e = -e;
+    sum += e;
+    if (e > worstUs) worstUs = e;
+  }
+  meanUs = sum / kReads;
+}
+
+int main() {
+  double isrMean = 0, isrWorst = 0, capMean = 0, capWorst = 0;
+  run(nullptr, isrMean, isrWorst);
+  hostsim::SimSqwCapture cap(4);               // AVR-like 4 µs capture resolution
+  run(&cap, capMean, capWorst);
+  std::printf("micros() in ISR: mean %.1f us, worst %.1f us; capture: mean %.1f us, worst %.1f us\n",
+              isrMean, isrWorst, capMean, capWorst);
+  CHECK(cap.captureCount() > 50);
+  CHECK(capWorst <= 8);                        // resolution + rounding
+  CHECK(capMean * 10 < isrMean);
+  return TEST_RESULT();
+}
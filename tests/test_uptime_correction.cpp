@@ -0,0 +1,86 @@
+// Uptime drift correction at the edges of its range: years without an adjust(), reference
+// steps far larger than any drift, and learning over intervals of months.
+#include "UptimeDateTimeProvider.h"
+#include "UptimeClock.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+static const uint64_t kSetMs = 1760000000000ULL;
+static const uint64_t kStepUs = 30ULL * 60ULL * 1000000ULL;   // inside the micros() wrap
+
+static void advanceMs(uint64_t ms) {
+  uint64_t left = ms * 1000ULL;
+  while (left) {
+    const uint64_t d = left < kStepUs ? left : kStepUs;
+    hostsim::advanceUs(d);
+    uptime::poll();
+    left -= d;
+  }
+}
+
+static sunlix::DateTime at(uint64_t unixMs) {
+  sunlix::DateTime t{};
+  civil::fromUnixMs(unixMs, t);
+  return t;
+}
+
+// ±1 % correction, ten years without an adjust(): past ~6.8 years (2.1e11 ms) the single
+// Q32 product of the old elapsedMs_() overflowed.
+static void yearsWithoutAdjust(int32_t ppb) {
+  test::freshSim();
+  UptimeDateTimeProvider up;
+  CHECK(up.begin());
+  up.setCorrectionPpb(ppb);
+  CHECK(up.adjust(at(kSetMs)));
+  const uint64_t setMs = hostsim::nowUs() / 1000U;
+
+  int64_t worst = 0;
+  for (int year = 1; year <= 10; ++year) {
+    advanceMs(365ULL * 86400000ULL);
+    uint64_t ms = 0;
+    CHECK(up.nowUnixMs(ms));
+    const __int128 el = static_cast<__int128>(hostsim::nowUs() / 1000U - setMs);
+    const __int128 q   = (static_cast<__int128>(ppb) << 32) / 1000000000;   // as applied (Q32)
+    const int64_t want = static_cast<int64_t>(kSetMs + el + ((el * q) >> 32));
+    const int64_t e = static_cast<int64_t>(ms) - want;
+    if ((e < 0 ? -e : e) > worst) worst = e < 0 ? -e : e;
+  }
+  std::printf("%+d ppb, ten years without adjust(): worst |error| %lld ms\n", ppb,
+              static_cast<long long>(worst));
+  CHECK(worst <= 1);
+}
+
+// A reference step of ~18 years between two trusted adjusts is a step, not drift. The old
+// (refEl - rawEl)·1e9 overflowed int64 first; this step wrapped it to a plausible 32 ppb.
+static void hugeStepIgnored() {
+  test::freshSim();
+  UptimeDateTimeProvider up;
+  CHECK(up.begin());
+  CHECK(up.adjustTrusted(at(kSetMs - 600000000000ULL)));
+  advanceMs(120000);
+  CHECK(up.adjustTrusted(at(kSetMs - 600000000000ULL + 120000ULL + 571849066285ULL)));
+  CHECK(up.correctionPpb() == 0);
+}
+
+// 150 days between trusted adjusts (rawEl > 2^33 ms) on a clock 20 ppm slow: learnt exactly.
+static void learnsOverMonths() {
+  test::freshSim();
+  UptimeDateTimeProvider up;
+  CHECK(up.begin());
+  CHECK(up.adjustTrusted(at(kSetMs)));
+  const uint64_t rawMs = 150ULL * 86400000ULL;
+  advanceMs(rawMs);
+  CHECK(up.adjustTrusted(at(kSetMs + rawMs + rawMs / 50000ULL)));   // +20 ppm
+  std::printf("150 days at +20 ppm: learnt %d ppb\n", static_cast<int>(up.correctionPpb()));
+  CHECK_NEAR(up.correctionPpb(), 20000, 5);
+}
+
+int main() {
+  yearsWithoutAdjust(10000000);
+  yearsWithoutAdjust(-10000000);
+  yearsWithoutAdjust(12345);
+  hugeStepIgnored();
+  learnsOverMonths();
+  return TEST_RESULT();
+}
@@ -0,0 +1,43 @@
+// Uptime provider across several micros() (71.6 min) and millis() (49.7 days) wraps.
+#include "UptimeDateTimeProvider.h"
+#include "UptimeClock.h"
+#include "TestSupport.h"
+
+using namespace sunlix;
+
+int main() {
+  test::freshSim();
+  UptimeDateTimeProvider up;
+  CHECK(up.begin());
+  sunlix::DateTime t0{};
+  civil::fromUnixMs(1760000000000ULL, t0);
+  CHECK(up.adjust(t0));
+  const uint64_t setUs = hostsim::nowUs();
+
+  // 160 days in 30 min steps (well inside the micros() wrap): three millis() wraps
+  const uint64_t kStepUs = 30ULL * 60ULL * 1000000ULL;
+  uint64_t prevMs = 0;
+  int64_t  worstMs = 0;
+  for (int i = 0; i < 160 * 48; ++i) {
+    hostsim::advanceUs(kStepUs);
+    uptime::poll();
+    uint64_t ms = 0;
+    CHECK(up.nowUnixMs(ms));
+    CHECK(ms > prevMs);
+    prevMs = ms;
+    const int64_t e = static_cast<int64_t>(ms - (1760000000000ULL + (hostsim::nowUs() - setUs) / 1000U));
+    if ((e < 0 ? -e : e) > worstMs) worstMs = e < 0 ? -e : e;
+  }
+  CHECK(hostsim::nowUs() - setUs > 3ULL * 0x100000000ULL * 1000ULL);   // > 3 millis() wraps
+  CHECK(worstMs <= 1);
+  CHECK(uptime::micros64() == hostsim::nowUs());
+  CHECK(uptime::millis64() == hostsim::nowUs() / 1000U);
+
+  sunlix::DateTime t{};
+  CHECK(up.nowUtc(t));
+  CHECK(t.year == 2026 && t.month == 3);                               // 2025-10-09 + 160 d
+  std::printf("160 days, %llu millis() wraps: worst |error| %lld ms\n",
+              static_cast<unsigned long long>((hostsim::nowUs() / 1000U) >> 32),
+              static_cast<long long>(worstMs));
+  return TEST_RESULT();
+}